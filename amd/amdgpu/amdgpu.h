@@ -86,6 +86,9 @@ extern int amdgpu_vm_size;
 extern int amdgpu_vm_block_size;
 extern int amdgpu_vm_fault_stop;
 extern int amdgpu_vm_debug;
+extern int amdgpu_vm_update_mode;
+extern int amdgpu_fence_spin_us;
+extern int amdgpu_sa_segregated;
 extern int amdgpu_sched_jobs;
 extern int amdgpu_sched_hw_submission;
 extern int amdgpu_powerplay;
@@ -98,6 +101,7 @@ extern char *amdgpu_disable_cu;
 extern int amdgpu_sclk_deep_sleep_en;
 extern char *amdgpu_virtual_display;
 extern unsigned amdgpu_pp_feature_mask;
+extern int amdgpu_atom_trace;
 
 #define AMDGPU_WAIT_IDLE_TIMEOUT_IN_MS	        3000
 #define AMDGPU_MAX_USEC_TIMEOUT			100000	/* 100 ms */
@@ -380,11 +384,17 @@ struct amdgpu_fence_driver {
 	unsigned			num_fences_mask;
 	spinlock_t			lock;
 	struct fence			**fences;
+	/* adaptive spinning before sleeping, see amdgpu_fence_wait() */
+	unsigned			wait_avg_us;
+	atomic64_t			spin_hits;
+	atomic64_t			spin_misses;
 };
 
 /* some special values for the owner field */
 #define AMDGPU_FENCE_OWNER_UNDEFINED	((void*)0ul)
 #define AMDGPU_FENCE_OWNER_VM		((void*)1ul)
+/* CPU page table updates, sync to VM updates and moves but not to CS */
+#define AMDGPU_FENCE_OWNER_VM_CPU	((void*)2ul)
 
 #define AMDGPU_FENCE_FLAG_64BIT         (1 << 0)
 #define AMDGPU_FENCE_FLAG_INT           (1 << 1)
@@ -415,6 +425,10 @@ struct amdgpu_bo_list_entry {
 	uint32_t			priority;
 	struct page			**user_pages;
 	int				user_invalidated;
+	/* cached validation state, see amdgpu_cs_list_validate() */
+	bool				resident;
+	uint32_t			resident_domains;
+	uint32_t			resident_moves;
 };
 
 struct amdgpu_bo_va_mapping {
@@ -461,6 +475,11 @@ struct amdgpu_bo {
 	void				*metadata;
 	u32				metadata_size;
 	unsigned			prime_shared_count;
+	/* how often recent submissions used this bo, see amdgpu_cs.c */
+	u32				cs_score;
+	u32				cs_last_seq;
+	/* bumped whenever TTM moves the bo */
+	u32				num_moves;
 	/* list of all virtual address to which this bo
 	 * is associated to
 	 */
@@ -525,6 +544,10 @@ int amdgpu_gem_debugfs_init(struct amdgpu_device *adev);
 
 #define AMDGPU_SA_NUM_FENCE_LISTS	32
 
+/* smallest block and maximum number of block sizes in segregated mode */
+#define AMDGPU_SA_SEG_MIN_SHIFT		8
+#define AMDGPU_SA_SEG_MAX_ORDERS	24
+
 struct amdgpu_sa_manager {
 	wait_queue_head_t	wq;
 	struct amdgpu_bo	*bo;
@@ -536,6 +559,12 @@ struct amdgpu_sa_manager {
 	void			*cpu_ptr;
 	uint32_t		domain;
 	uint32_t		align;
+
+	/* segregated mode, free buddy blocks binned by order */
+	bool			segregated;
+	unsigned		seg_orders;
+	unsigned		seg_nbits[AMDGPU_SA_SEG_MAX_ORDERS];
+	unsigned long		*seg_free[AMDGPU_SA_SEG_MAX_ORDERS];
 };
 
 /* sub-allocation buffer */
@@ -863,6 +892,9 @@ struct amdgpu_vm {
 
 	/* client id */
 	u64                     client_id;
+
+	/* write PTEs with the CPU instead of SDMA */
+	bool			use_cpu_for_update;
 };
 
 struct amdgpu_vm_id {
@@ -1230,6 +1262,7 @@ struct amdgpu_cs_parser {
 	struct fence			*fence;
 	uint64_t			bytes_moved_threshold;
 	uint64_t			bytes_moved;
+	u32				cs_seq;
 	struct amdgpu_bo_list_entry	*evictable;
 
 	/* user fence */
@@ -2056,6 +2089,11 @@ struct amdgpu_device {
 		s64			last_update_us;
 		s64			accum_us; /* accumulated microseconds */
 		u32			log2_max_MBps;
+		u32			cs_seq; /* submissions seen */
+		/* copy throughput of completed blit moves */
+		atomic64_t		sample_bytes;
+		atomic64_t		sample_ns;
+		atomic64_t		last_move_ns;
 	} mm_stats;
 
 	/* display */
@@ -1817,3 +1817,103 @@ void amdgpu_atombios_copy_swap(u8 *dst, u8 *src, u8 num_bytes, bool to_le)
 	memcpy(dst, src, num_bytes);
 #endif
 }
+
+#if defined(CONFIG_DEBUG_FS)
+static int amdgpu_debugfs_atom_stats(struct seq_file *m, void *data)
+{
+	struct drm_info_node *node = (struct drm_info_node *) m->private;
+	struct drm_device *dev = node->minor->dev;
+	struct amdgpu_device *adev = dev->dev_private;
+	struct atom_context *ctx = adev->mode_info.atom_context;
+	struct atom_table_stats *stats;
+	unsigned i;
+
+	if (!ctx)
+		return 0;
+
+	seq_printf(m, "%-36s %10s %12s %12s %12s %12s %12s\n",
+		   "table", "calls", "total_us", "max_us", "ops",
+		   "delay_us", "iio_us");
+	mutex_lock(&ctx->mutex);
+	for (i = 0; i < ctx->num_tables; i++) {
+		stats = &ctx->stats[i];
+		if (!stats->calls)
+			continue;
+		seq_printf(m, "%3u %-32s %10llu %12llu %12llu %12llu %12llu %12llu\n",
+			   i, amdgpu_atom_table_name(i),
+			   (unsigned long long)stats->calls,
+			   (unsigned long long)div_u64(stats->total_ns, 1000),
+			   (unsigned long long)div_u64(stats->max_ns, 1000),
+			   (unsigned long long)stats->ops,
+			   (unsigned long long)div_u64(stats->delay_ns, 1000),
+			   (unsigned long long)div_u64(stats->iio_ns, 1000));
+	}
+	mutex_unlock(&ctx->mutex);
+	return 0;
+}
+
+static int amdgpu_debugfs_atom_trace(struct seq_file *m, void *data)
+{
+	struct drm_info_node *node = (struct drm_info_node *) m->private;
+	struct drm_device *dev = node->minor->dev;
+	struct amdgpu_device *adev = dev->dev_private;
+	struct atom_context *ctx = adev->mode_info.atom_context;
+	struct atom_trace_entry *e;
+	unsigned i, n, first;
+
+	if (!ctx)
+		return 0;
+
+	mutex_lock(&ctx->mutex);
+	if (!ctx->trace) {
+		mutex_unlock(&ctx->mutex);
+		seq_printf(m, "tracing disabled, load with amdgpu.atom_trace=<entries>\n");
+		return 0;
+	}
+	n = min_t(uint64_t, ctx->trace_count, ctx->trace_size);
+	first = (ctx->trace_head + ctx->trace_size - n) % ctx->trace_size;
+	seq_printf(m, "%llu records, %u shown\n",
+		   (unsigned long long)ctx->trace_count, n);
+	for (i = 0; i < n; i++) {
+		e = &ctx->trace[(first + i) % ctx->trace_size];
+		if (e->type == ATOM_TRACE_ENTER)
+			seq_printf(m, "%llu %*s> %u %s\n",
+				   (unsigned long long)e->timestamp_ns,
+				   e->depth * 2, "", e->index,
+				   amdgpu_atom_table_name(e->index));
+		else
+			seq_printf(m, "%llu %*s< %u %lluns ret %d\n",
+				   (unsigned long long)e->timestamp_ns,
+				   e->depth * 2, "", e->index,
+				   (unsigned long long)e->duration_ns, e->ret);
+	}
+	mutex_unlock(&ctx->mutex);
+	return 0;
+}
+
+static const struct drm_info_list amdgpu_atom_debugfs_list[] = {
+	{"amdgpu_atom_stats", amdgpu_debugfs_atom_stats, 0, NULL},
+	{"amdgpu_atom_trace", amdgpu_debugfs_atom_trace, 0, NULL},
+};
+#endif
+
+int amdgpu_atombios_debugfs_init(struct amdgpu_device *adev)
+{
+#if defined(CONFIG_DEBUG_FS)
+	struct atom_context *ctx = adev->mode_info.atom_context;
+	int r;
+
+	if (!ctx)
+		return 0;
+
+	if (amdgpu_atom_trace > 0) {
+		r = amdgpu_atom_trace_alloc(ctx, amdgpu_atom_trace);
+		if (r)
+			DRM_ERROR("failed to allocate atom trace ring (%d).\n", r);
+	}
+	return amdgpu_debugfs_add_files(adev, amdgpu_atom_debugfs_list,
+					ARRAY_SIZE(amdgpu_atom_debugfs_list));
+#else
+	return 0;
+#endif
+}
@@ -261,6 +261,42 @@ static s64 bytes_to_us(struct amdgpu_device *adev, u64 bytes)
 	return bytes >> adev->mm_stats.log2_max_MBps;
 }
 
+/* When the migration rate is automatic, allow migrations to use 1/64th of
+ * the copy throughput measured from completed moves, but never less than
+ * the 8 MB/s default. Re-evaluated once enough bytes have been sampled.
+ */
+#define AMDGPU_MOVE_BW_SHIFT		6
+#define AMDGPU_MOVE_MIN_MBPS		8
+#define AMDGPU_MOVE_SAMPLE_BYTES	(32ULL * 1024 * 1024)
+
+static void amdgpu_cs_update_move_rate(struct amdgpu_device *adev)
+{
+	u64 bytes, ns, MBps;
+	u32 log2_MBps;
+
+	if (amdgpu_moverate >= 0)
+		return;
+
+	bytes = atomic64_read(&adev->mm_stats.sample_bytes);
+	if (bytes < AMDGPU_MOVE_SAMPLE_BYTES)
+		return;
+
+	ns = atomic64_read(&adev->mm_stats.sample_ns);
+	atomic64_sub(bytes, &adev->mm_stats.sample_bytes);
+	atomic64_sub(ns, &adev->mm_stats.sample_ns);
+	if (!ns)
+		return;
+
+	/* bytes per ns times 1000 is MB/s */
+	MBps = div64_u64(bytes * 1000, ns);
+	log2_MBps = ilog2(max_t(u64, MBps >> AMDGPU_MOVE_BW_SHIFT,
+				AMDGPU_MOVE_MIN_MBPS));
+	if (log2_MBps != adev->mm_stats.log2_max_MBps)
+		DRM_DEBUG_DRIVER("measured %llu MB/s copy rate, migration rate now %u MB/s\n",
+				 (unsigned long long)MBps, 1u << log2_MBps);
+	adev->mm_stats.log2_max_MBps = log2_MBps;
+}
+
 /* Returns how many bytes TTM can move right now. If no bytes can be moved,
  * it returns 0. If it returns non-zero, it's OK to move at least one buffer,
  * which means it can go over the threshold once. If that happens, the driver
@@ -298,6 +334,8 @@ static u64 amdgpu_cs_get_threshold_for_moves(struct amdgpu_device *adev)
 
 	spin_lock(&adev->mm_stats.lock);
 
+	amdgpu_cs_update_move_rate(adev);
+
 	/* Increase the amount of accumulated us. */
 	time_us = ktime_to_us(ktime_get());
 	increment_us = time_us - adev->mm_stats.last_update_us;
@@ -335,6 +373,7 @@ static u64 amdgpu_cs_get_threshold_for_moves(struct amdgpu_device *adev)
 	 * buffer moves.
 	 */
 	max_bytes = us_to_bytes(adev, adev->mm_stats.accum_us);
+	adev->mm_stats.cs_seq++;
 
 	spin_unlock(&adev->mm_stats.lock);
 	return max_bytes;
@@ -352,20 +391,53 @@ static void amdgpu_cs_report_moved_bytes(struct amdgpu_device *adev,
 	spin_unlock(&adev->mm_stats.lock);
 }
 
+/* Per BO usage score: every submission using the BO adds AMDGPU_CS_SCORE_INC,
+ * and the score halves for every AMDGPU_CS_SCORE_DECAY submissions the BO
+ * sat out. BOs at or above AMDGPU_CS_SCORE_HOT are considered part of the
+ * working set.
+ */
+#define AMDGPU_CS_SCORE_INC	16
+#define AMDGPU_CS_SCORE_DECAY	8
+#define AMDGPU_CS_SCORE_HOT	64
+#define AMDGPU_CS_SCORE_MAX	256
+
+static bool amdgpu_cs_bo_is_hot(struct amdgpu_cs_parser *p,
+				struct amdgpu_bo *bo)
+{
+	u32 idle = p->cs_seq - bo->cs_last_seq;
+
+	if (idle) {
+		idle /= AMDGPU_CS_SCORE_DECAY;
+		bo->cs_score = idle >= 32 ? 0 : bo->cs_score >> idle;
+		bo->cs_score = min_t(u32, bo->cs_score + AMDGPU_CS_SCORE_INC,
+				     AMDGPU_CS_SCORE_MAX);
+		bo->cs_last_seq = p->cs_seq;
+	}
+
+	return bo->cs_score >= AMDGPU_CS_SCORE_HOT;
+}
+
 static int amdgpu_cs_bo_validate(struct amdgpu_cs_parser *p,
 				 struct amdgpu_bo *bo)
 {
 	u64 initial_bytes_moved;
 	uint32_t domain;
+	bool hot;
 	int r;
 
 	if (bo->pin_count)
 		return 0;
 
+	hot = amdgpu_cs_bo_is_hot(p, bo);
+
 	/* Don't move this buffer if we have depleted our allowance
 	 * to move it. Don't move anything if the threshold is zero.
+	 * Only the first half of the allowance is open to BOs which
+	 * recent submissions rarely used, so that they don't push the
+	 * working set out of VRAM.
 	 */
-	if (p->bytes_moved < p->bytes_moved_threshold)
+	if (p->bytes_moved < p->bytes_moved_threshold &&
+	    (hot || p->bytes_moved < p->bytes_moved_threshold / 2))
 		domain = bo->prefered_domains;
 	else
 		domain = bo->allowed_domains;
@@ -464,6 +536,16 @@ static int amdgpu_cs_list_validate(struct amdgpu_cs_parser *p,
 		if (p->evictable == lobj)
 			p->evictable = NULL;
 
+		/* Nothing to do if the BO hasn't moved since it was last
+		 * validated into its preferred domain from this entry.
+		 */
+		if (lobj->resident && !binding_userptr && !bo->pin_count &&
+		    lobj->resident_moves == bo->num_moves &&
+		    lobj->resident_domains == bo->prefered_domains) {
+			amdgpu_cs_bo_is_hot(p, bo);
+			continue;
+		}
+
 		do {
 			r = amdgpu_cs_bo_validate(p, bo);
 		} while (r == -ENOMEM && amdgpu_cs_try_evict(p, lobj));
@@ -476,6 +558,11 @@ static int amdgpu_cs_list_validate(struct amdgpu_cs_parser *p,
 				return r;
 		}
 
+		lobj->resident = !!(bo->prefered_domains &
+			amdgpu_mem_type_to_domain(bo->tbo.mem.mem_type));
+		lobj->resident_moves = bo->num_moves;
+		lobj->resident_domains = bo->prefered_domains;
+
 		if (binding_userptr) {
 			drm_free_large(lobj->user_pages);
 			lobj->user_pages = NULL;
@@ -598,6 +685,7 @@ static int amdgpu_cs_parser_bos(struct amdgpu_cs_parser *p,
 
 	p->bytes_moved_threshold = amdgpu_cs_get_threshold_for_moves(p->adev);
 	p->bytes_moved = 0;
+	p->cs_seq = p->adev->mm_stats.cs_seq;
 	p->evictable = list_last_entry(&p->validated,
 				       struct amdgpu_bo_list_entry,
 				       tv.head);
@@ -875,6 +875,8 @@ static void amdgpu_atombios_fini(struct amdgpu_device *adev)
 	if (adev->mode_info.atom_context) {
 		kfree(adev->mode_info.atom_context->scratch);
 		kfree(adev->mode_info.atom_context->iio);
+		kfree(adev->mode_info.atom_context->stats);
+		kfree(adev->mode_info.atom_context->trace);
 	}
 	kfree(adev->mode_info.atom_context);
 	adev->mode_info.atom_context = NULL;
@@ -1830,6 +1832,11 @@ int amdgpu_device_init(struct amdgpu_device *adev,
 		return r;
 	}
 
+	r = amdgpu_atombios_debugfs_init(adev);
+	if (r) {
+		DRM_ERROR("registering atom debugfs failed (%d).\n", r);
+	}
+
 	if ((amdgpu_testing & 1)) {
 		if (adev->accel_working)
 			amdgpu_test_moves(adev);
@@ -88,6 +88,9 @@ int amdgpu_vm_size = 64;
 int amdgpu_vm_block_size = -1;
 int amdgpu_vm_fault_stop = 0;
 int amdgpu_vm_debug = 0;
+int amdgpu_vm_update_mode = 0;
+int amdgpu_fence_spin_us = 10;
+int amdgpu_sa_segregated = 0;
 int amdgpu_exp_hw_support = 0;
 int amdgpu_sched_jobs = 32;
 int amdgpu_sched_hw_submission = 2;
@@ -101,6 +104,7 @@ unsigned amdgpu_pg_mask = 0xffffffff;
 char *amdgpu_disable_cu = NULL;
 char *amdgpu_virtual_display = NULL;
 unsigned amdgpu_pp_feature_mask = 0xffffffff;
+int amdgpu_atom_trace = 0;
 
 MODULE_PARM_DESC(vramlimit, "Restrict VRAM for testing, in megabytes");
 module_param_named(vramlimit, amdgpu_vram_limit, int, 0600);
@@ -168,6 +172,15 @@ module_param_named(vm_fault_stop, amdgpu_vm_fault_stop, int, 0444);
 MODULE_PARM_DESC(vm_debug, "Debug VM handling (0 = disabled (default), 1 = enabled)");
 module_param_named(vm_debug, amdgpu_vm_debug, int, 0644);
 
+MODULE_PARM_DESC(vm_update_mode, "VM page table update mode (0 = SDMA (default), 1 = CPU if all of VRAM is CPU visible)");
+module_param_named(vm_update_mode, amdgpu_vm_update_mode, int, 0444);
+
+MODULE_PARM_DESC(fence_spin_us, "Maximum time to busy-wait on a fence before sleeping, in microseconds (0 = disabled, default 10)");
+module_param_named(fence_spin_us, amdgpu_fence_spin_us, int, 0644);
+
+MODULE_PARM_DESC(sa_segregated, "Segregated-fit IB pool suballocation (1 = enable, 0 = ring allocator (default))");
+module_param_named(sa_segregated, amdgpu_sa_segregated, int, 0444);
+
 MODULE_PARM_DESC(exp_hw_support, "experimental hw support (1 = enable, 0 = disable (default))");
 module_param_named(exp_hw_support, amdgpu_exp_hw_support, int, 0444);
 
@@ -201,6 +214,9 @@ module_param_named(cg_mask, amdgpu_cg_mask, uint, 0444);
 MODULE_PARM_DESC(pg_mask, "Powergating flags mask (0 = disable power gating)");
 module_param_named(pg_mask, amdgpu_pg_mask, uint, 0444);
 
+MODULE_PARM_DESC(atom_trace, "Number of ATOM table entry/exit records to keep in the debugfs trace ring (0 = disabled (default))");
+module_param_named(atom_trace, amdgpu_atom_trace, int, 0444);
+
 #ifndef __FreeBSD__
 MODULE_PARM_DESC(disable_cu, "Disable CUs (se.sh.cu,...)");
 module_param_named(disable_cu, amdgpu_disable_cu, charp, 0444);
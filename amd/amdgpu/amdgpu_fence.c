@@ -371,6 +371,9 @@ int amdgpu_fence_driver_init_ring(struct amdgpu_ring *ring,
 	ring->fence_drv.sync_seq = 0;
 	atomic_set(&ring->fence_drv.last_seq, 0);
 	ring->fence_drv.initialized = false;
+	ring->fence_drv.wait_avg_us = 0;
+	atomic64_set(&ring->fence_drv.spin_hits, 0);
+	atomic64_set(&ring->fence_drv.spin_misses, 0);
 
 	setup_timer(&ring->fence_drv.fallback_timer, amdgpu_fence_fallback,
 		    (unsigned long)ring);
@@ -601,11 +604,132 @@ static void amdgpu_fence_release(struct fence *f)
 	call_rcu(&f->rcu, amdgpu_fence_free);
 }
 
+/* longest wait accounted in the running average */
+#define AMDGPU_FENCE_WAIT_AVG_MAX_US	10000
+
+/**
+ * amdgpu_fence_spin_budget - how long to busy-wait before sleeping
+ *
+ * @drv: fence driver of the ring
+ *
+ * Spin for about twice the recent average wait, capped by the
+ * fence_spin_us module parameter. When recent waits were longer than
+ * the cap spinning would just burn CPU, so only spin for a fraction of
+ * it to notice when the ring gets back to short jobs.
+ */
+static unsigned amdgpu_fence_spin_budget(struct amdgpu_fence_driver *drv)
+{
+	unsigned hi = amdgpu_fence_spin_us;
+	unsigned lo = hi / 8 ? hi / 8 : 1;
+	unsigned avg = ACCESS_ONCE(drv->wait_avg_us);
+
+	if (amdgpu_fence_spin_us <= 0)
+		return 0;
+
+	if (avg > hi)
+		return lo;
+
+	return clamp(2 * avg, lo, hi);
+}
+
+/**
+ * amdgpu_fence_wait_account - update the running average wait time
+ *
+ * @drv: fence driver of the ring
+ * @start: when the wait started
+ */
+static void amdgpu_fence_wait_account(struct amdgpu_fence_driver *drv,
+				      ktime_t start)
+{
+	s64 us = ktime_to_us(ktime_sub(ktime_get(), start));
+	unsigned avg = ACCESS_ONCE(drv->wait_avg_us);
+
+	us = min_t(s64, us, AMDGPU_FENCE_WAIT_AVG_MAX_US);
+	ACCESS_ONCE(drv->wait_avg_us) = (avg * 7 + (unsigned)us) / 8;
+}
+
+/**
+ * amdgpu_fence_spin - busy-wait for a fence
+ *
+ * @fence: fence to wait for
+ * @intr: stop on pending signals
+ * @start: when the wait started
+ * @budget_us: how long to spin
+ *
+ * Poll the fence memory for a short while, so that short jobs don't
+ * pay for the interrupt and wake-up latency.
+ * Returns true if the fence signaled while spinning.
+ */
+static bool amdgpu_fence_spin(struct amdgpu_fence *fence, bool intr,
+			      ktime_t start, unsigned budget_us)
+{
+	struct amdgpu_ring *ring = fence->ring;
+
+	do {
+		if ((int32_t)(amdgpu_fence_read(ring) - fence->base.seqno) >= 0)
+			amdgpu_fence_process(ring);
+
+		if (fence_is_signaled(&fence->base))
+			return true;
+
+		if (intr && signal_pending(current))
+			break;
+
+		if (ktime_to_us(ktime_sub(ktime_get(), start)) >= budget_us)
+			break;
+
+		cpu_relax();
+	} while (!need_resched());
+
+	return false;
+}
+
+/**
+ * amdgpu_fence_wait - wait for a fence to signal
+ *
+ * @f: fence
+ * @intr: use interruptible sleep
+ * @timeout: maximum time to wait in jiffies
+ *
+ * Spin for a little while before falling back to fence_default_wait(),
+ * see amdgpu_fence_spin_budget() for how long.
+ * Returns the remaining timeout, 0 on timeout or -ERESTARTSYS.
+ */
+static signed long amdgpu_fence_wait(struct fence *f, bool intr,
+				     signed long timeout)
+{
+	struct amdgpu_fence *fence = to_amdgpu_fence(f);
+	struct amdgpu_fence_driver *drv = &fence->ring->fence_drv;
+	unsigned budget;
+	ktime_t start;
+	signed long r;
+
+	if (!timeout || fence_is_signaled(f))
+		return fence_default_wait(f, intr, timeout);
+
+	start = ktime_get();
+	budget = amdgpu_fence_spin_budget(drv);
+	if (budget) {
+		if (amdgpu_fence_spin(fence, intr, start, budget)) {
+			atomic64_inc(&drv->spin_hits);
+			amdgpu_fence_wait_account(drv, start);
+			return timeout;
+		}
+		atomic64_inc(&drv->spin_misses);
+	}
+
+	r = fence_default_wait(f, intr, timeout);
+	if (r > 0)
+		amdgpu_fence_wait_account(drv, start);
+
+	return r;
+}
+
 static const struct fence_ops amdgpu_fence_ops = {
 	.get_driver_name = amdgpu_fence_get_driver_name,
 	.get_timeline_name = amdgpu_fence_get_timeline_name,
 	.enable_signaling = amdgpu_fence_enable_signaling,
-	.wait = fence_default_wait,
+	.wait = amdgpu_fence_wait,
 	.release = amdgpu_fence_release,
 };
 
@@ -632,6 +756,12 @@ static int amdgpu_debugfs_fence_info(struct seq_file *m, void *data)
 			   atomic_read(&ring->fence_drv.last_seq));
 		seq_printf(m, "Last emitted        0x%08x\n",
 			   ring->fence_drv.sync_seq);
+		seq_printf(m, "Average wait        %u us\n",
+			   ACCESS_ONCE(ring->fence_drv.wait_avg_us));
+		seq_printf(m, "Spin hits           %llu\n",
+			   (unsigned long long)atomic64_read(&ring->fence_drv.spin_hits));
+		seq_printf(m, "Spin misses         %llu\n",
+			   (unsigned long long)atomic64_read(&ring->fence_drv.spin_misses));
 	}
 	return 0;
 }
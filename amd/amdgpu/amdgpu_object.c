@@ -867,6 +867,10 @@ void amdgpu_bo_move_notify(struct ttm_buffer_object *bo,
 	abo = container_of(bo, struct amdgpu_bo, tbo);
 	amdgpu_vm_bo_invalidate(abo->adev, abo);
 
+	/* a kernel mapping would point to the old location */
+	amdgpu_bo_kunmap(abo);
+	abo->num_moves++;
+
 	/* update statistics */
 	if (!new_mem)
 		return;
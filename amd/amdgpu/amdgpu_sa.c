@@ -40,6 +40,12 @@
  *
  * If we are asked to block we wait on all the oldest fence of all
  * rings. We just wait for any of those fence to complete.
+ *
+ * With the sa_segregated module parameter the manager instead splits the
+ * buffer into power of two buddy blocks binned by size.  Freed bos still
+ * go to the per ring fence lists, but every ring returns its retired
+ * blocks on its own, so a slow ring no longer holds a single hole back
+ * for all the others.  Free buddies are merged again on release.
  */
 #include <drm/drmP.h>
 #include "amdgpu.h"
@@ -47,6 +53,214 @@
 static void amdgpu_sa_bo_remove_locked(struct amdgpu_sa_bo *sa_bo);
 static void amdgpu_sa_bo_try_free(struct amdgpu_sa_manager *sa_manager);
 
+static unsigned amdgpu_sa_seg_order(unsigned size, unsigned align)
+{
+	unsigned bytes = max(size, align);
+	unsigned order = 0;
+
+	while ((1u << (AMDGPU_SA_SEG_MIN_SHIFT + order)) < bytes)
+		++order;
+	return order;
+}
+
+static void amdgpu_sa_seg_put_block(struct amdgpu_sa_manager *sa_manager,
+				    unsigned soffset, unsigned order)
+{
+	unsigned idx = soffset >> (AMDGPU_SA_SEG_MIN_SHIFT + order);
+	unsigned buddy;
+
+	/* merge with the buddy for as long as it is free as well */
+	while (order + 1 < sa_manager->seg_orders) {
+		buddy = idx ^ 1;
+		if (buddy >= sa_manager->seg_nbits[order] ||
+		    !test_bit(buddy, sa_manager->seg_free[order]))
+			break;
+		__clear_bit(buddy, sa_manager->seg_free[order]);
+		idx >>= 1;
+		++order;
+	}
+	__set_bit(idx, sa_manager->seg_free[order]);
+}
+
+static bool amdgpu_sa_seg_get_block(struct amdgpu_sa_manager *sa_manager,
+				    unsigned order, unsigned *soffset)
+{
+	unsigned k, idx;
+
+	for (k = order; k < sa_manager->seg_orders; ++k) {
+		idx = find_first_bit(sa_manager->seg_free[k],
+				     sa_manager->seg_nbits[k]);
+		if (idx >= sa_manager->seg_nbits[k])
+			continue;
+
+		__clear_bit(idx, sa_manager->seg_free[k]);
+		/* split, keeping the lower half and freeing the upper one */
+		while (k > order) {
+			--k;
+			idx <<= 1;
+			__set_bit(idx + 1, sa_manager->seg_free[k]);
+		}
+		*soffset = idx << (AMDGPU_SA_SEG_MIN_SHIFT + order);
+		return true;
+	}
+	return false;
+}
+
+static bool amdgpu_sa_seg_has_block(struct amdgpu_sa_manager *sa_manager,
+				    unsigned order)
+{
+	unsigned k;
+
+	for (k = order; k < sa_manager->seg_orders; ++k)
+		if (find_first_bit(sa_manager->seg_free[k],
+				   sa_manager->seg_nbits[k]) <
+		    sa_manager->seg_nbits[k])
+			return true;
+	return false;
+}
+
+static int amdgpu_sa_seg_init(struct amdgpu_sa_manager *sa_manager)
+{
+	unsigned blocks = sa_manager->size >> AMDGPU_SA_SEG_MIN_SHIFT;
+	unsigned i, longs, soffset, order, block;
+	unsigned long *bits;
+
+	sa_manager->seg_orders = 0;
+	while (sa_manager->seg_orders < AMDGPU_SA_SEG_MAX_ORDERS &&
+	       (1u << sa_manager->seg_orders) <= blocks)
+		++sa_manager->seg_orders;
+	if (!sa_manager->seg_orders)
+		return -EINVAL;
+
+	for (i = 0, longs = 0; i < sa_manager->seg_orders; ++i) {
+		sa_manager->seg_nbits[i] = blocks >> i;
+		longs += BITS_TO_LONGS(sa_manager->seg_nbits[i]);
+	}
+
+	bits = kcalloc(longs, sizeof(unsigned long), GFP_KERNEL);
+	if (!bits)
+		return -ENOMEM;
+
+	for (i = 0; i < sa_manager->seg_orders; ++i) {
+		sa_manager->seg_free[i] = bits;
+		bits += BITS_TO_LONGS(sa_manager->seg_nbits[i]);
+	}
+
+	/* seed the free lists with the largest aligned blocks that fit */
+	for (soffset = 0; soffset < (blocks << AMDGPU_SA_SEG_MIN_SHIFT);
+	     soffset += block) {
+		order = sa_manager->seg_orders - 1;
+		block = 1u << (AMDGPU_SA_SEG_MIN_SHIFT + order);
+		while ((soffset & (block - 1)) ||
+		       soffset + block > sa_manager->size) {
+			--order;
+			block >>= 1;
+		}
+		amdgpu_sa_seg_put_block(sa_manager, soffset, order);
+	}
+	return 0;
+}
+
+/* hand back what any ring has retired, without waiting on the others */
+static void amdgpu_sa_seg_try_free(struct amdgpu_sa_manager *sa_manager)
+{
+	struct amdgpu_sa_bo *sa_bo, *tmp;
+	int i;
+
+	for (i = 0; i < AMDGPU_SA_NUM_FENCE_LISTS; ++i) {
+		list_for_each_entry_safe(sa_bo, tmp, &sa_manager->flist[i],
+					 flist) {
+			if (!fence_is_signaled(sa_bo->fence))
+				break;
+			amdgpu_sa_bo_remove_locked(sa_bo);
+		}
+	}
+}
+
+static bool amdgpu_sa_seg_try_alloc(struct amdgpu_sa_manager *sa_manager,
+				    struct amdgpu_sa_bo *sa_bo,
+				    unsigned size, unsigned align)
+{
+	unsigned order = amdgpu_sa_seg_order(size, align);
+	unsigned soffset;
+
+	if (!amdgpu_sa_seg_get_block(sa_manager, order, &soffset))
+		return false;
+
+	sa_bo->manager = sa_manager;
+	sa_bo->soffset = soffset;
+	sa_bo->eoffset = soffset + (1u << (AMDGPU_SA_SEG_MIN_SHIFT + order));
+	list_add_tail(&sa_bo->olist, &sa_manager->olist);
+	INIT_LIST_HEAD(&sa_bo->flist);
+	return true;
+}
+
+static bool amdgpu_sa_seg_event(struct amdgpu_sa_manager *sa_manager,
+				unsigned size, unsigned align)
+{
+	int i;
+
+	for (i = 0; i < AMDGPU_SA_NUM_FENCE_LISTS; ++i)
+		if (!list_empty(&sa_manager->flist[i]))
+			return true;
+
+	return amdgpu_sa_seg_has_block(sa_manager,
+				       amdgpu_sa_seg_order(size, align));
+}
+
+static int amdgpu_sa_seg_bo_new(struct amdgpu_sa_manager *sa_manager,
+				struct amdgpu_sa_bo *sa_bo,
+				unsigned size, unsigned align)
+{
+	struct fence *fences[AMDGPU_SA_NUM_FENCE_LISTS];
+	struct amdgpu_sa_bo *oldest;
+	unsigned count;
+	int i, r;
+	signed long t;
+
+	if (amdgpu_sa_seg_order(size, align) >= sa_manager->seg_orders)
+		return -EINVAL;
+
+	spin_lock(&sa_manager->wq.lock);
+	do {
+		amdgpu_sa_seg_try_free(sa_manager);
+
+		if (amdgpu_sa_seg_try_alloc(sa_manager, sa_bo, size, align)) {
+			spin_unlock(&sa_manager->wq.lock);
+			return 0;
+		}
+
+		/* wait for whichever ring retires its oldest bo first */
+		for (i = 0, count = 0; i < AMDGPU_SA_NUM_FENCE_LISTS; ++i) {
+			if (list_empty(&sa_manager->flist[i]))
+				continue;
+			oldest = list_first_entry(&sa_manager->flist[i],
+						  struct amdgpu_sa_bo, flist);
+			fences[count++] = fence_get(oldest->fence);
+		}
+
+		if (count) {
+			spin_unlock(&sa_manager->wq.lock);
+			t = fence_wait_any_timeout(fences, count, false,
+						   MAX_SCHEDULE_TIMEOUT);
+			for (i = 0; i < count; ++i)
+				fence_put(fences[i]);
+
+			r = (t > 0) ? 0 : t;
+			spin_lock(&sa_manager->wq.lock);
+		} else {
+			/* if we have nothing to wait for block */
+			r = wait_event_interruptible_locked(
+				sa_manager->wq,
+				amdgpu_sa_seg_event(sa_manager, size, align)
+			);
+		}
+	} while (!r);
+
+	spin_unlock(&sa_manager->wq.lock);
+	return r;
+}
+
 int amdgpu_sa_bo_manager_init(struct amdgpu_device *adev,
 			      struct amdgpu_sa_manager *sa_manager,
 			      unsigned size, u32 align, u32 domain)
@@ -63,10 +277,21 @@ int amdgpu_sa_bo_manager_init(struct amdgpu_device *adev,
 	for (i = 0; i < AMDGPU_SA_NUM_FENCE_LISTS; ++i)
 		INIT_LIST_HEAD(&sa_manager->flist[i]);
 
+	sa_manager->segregated = amdgpu_sa_segregated != 0;
+	if (sa_manager->segregated) {
+		r = amdgpu_sa_seg_init(sa_manager);
+		if (r) {
+			dev_err(adev->dev, "(%d) failed to init segregated sa manager\n", r);
+			return r;
+		}
+	}
+
 	r = amdgpu_bo_create(adev, size, align, true, domain,
 			     0, NULL, NULL, &sa_manager->bo);
 	if (r) {
 		dev_err(adev->dev, "(%d) failed to allocate bo for manager\n", r);
+		if (sa_manager->segregated)
+			kfree(sa_manager->seg_free[0]);
 		return r;
 	}
 
@@ -79,8 +304,11 @@ void amdgpu_sa_bo_manager_fini(struct amdgpu_device *adev,
 	struct amdgpu_sa_bo *sa_bo, *tmp;
 
 	if (!list_empty(&sa_manager->olist)) {
-		sa_manager->hole = &sa_manager->olist,
-		amdgpu_sa_bo_try_free(sa_manager);
+		sa_manager->hole = &sa_manager->olist;
+		if (sa_manager->segregated)
+			amdgpu_sa_seg_try_free(sa_manager);
+		else
+			amdgpu_sa_bo_try_free(sa_manager);
 		if (!list_empty(&sa_manager->olist)) {
 			dev_err(adev->dev, "sa_manager is not empty, clearing anyway\n");
 		}
@@ -88,6 +316,10 @@ void amdgpu_sa_bo_manager_fini(struct amdgpu_device *adev,
 	list_for_each_entry_safe(sa_bo, tmp, &sa_manager->olist, olist) {
 		amdgpu_sa_bo_remove_locked(sa_bo);
 	}
+	if (sa_manager->segregated) {
+		kfree(sa_manager->seg_free[0]);
+		sa_manager->segregated = false;
+	}
 	amdgpu_bo_unref(&sa_manager->bo);
 	sa_manager->size = 0;
 }
@@ -142,7 +374,11 @@ int amdgpu_sa_bo_manager_suspend(struct amdgpu_device *adev,
 static void amdgpu_sa_bo_remove_locked(struct amdgpu_sa_bo *sa_bo)
 {
 	struct amdgpu_sa_manager *sa_manager = sa_bo->manager;
-	if (sa_manager->hole == &sa_bo->olist) {
+	if (sa_manager->segregated) {
+		amdgpu_sa_seg_put_block(sa_manager, sa_bo->soffset,
+			ilog2((sa_bo->eoffset - sa_bo->soffset) >>
+			      AMDGPU_SA_SEG_MIN_SHIFT));
+	} else if (sa_manager->hole == &sa_bo->olist) {
 		sa_manager->hole = sa_bo->olist.prev;
 	}
 	list_del_init(&sa_bo->olist);
@@ -335,6 +571,15 @@ int amdgpu_sa_bo_new(struct amdgpu_sa_manager *sa_manager,
 	INIT_LIST_HEAD(&(*sa_bo)->olist);
 	INIT_LIST_HEAD(&(*sa_bo)->flist);
 
+	if (sa_manager->segregated) {
+		r = amdgpu_sa_seg_bo_new(sa_manager, *sa_bo, size, align);
+		if (r) {
+			kfree(*sa_bo);
+			*sa_bo = NULL;
+		}
+		return r;
+	}
+
 	spin_lock(&sa_manager->wq.lock);
 	do {
 		for (i = 0; i < AMDGPU_SA_NUM_FENCE_LISTS; ++i) {
@@ -414,6 +659,7 @@ void amdgpu_sa_bo_dump_debug_info(struct amdgpu_sa_manager *sa_manager,
 				  struct seq_file *m)
 {
 	struct amdgpu_sa_bo *i;
+	unsigned j;
 
 	spin_lock(&sa_manager->wq.lock);
 	list_for_each_entry(i, &sa_manager->olist, olist) {
@@ -433,6 +679,11 @@ void amdgpu_sa_bo_dump_debug_info(struct amdgpu_sa_manager *sa_manager,
 
 		seq_printf(m, "\n");
 	}
+	for (j = 0; sa_manager->segregated && j < sa_manager->seg_orders; ++j)
+		seq_printf(m, "free blocks of %8u bytes: %u\n",
+			   1u << (AMDGPU_SA_SEG_MIN_SHIFT + j),
+			   bitmap_weight(sa_manager->seg_free[j],
+					 sa_manager->seg_nbits[j]));
 	spin_unlock(&sa_manager->wq.lock);
 }
 #endif
@@ -201,6 +201,18 @@ int amdgpu_sync_resv(struct amdgpu_device *adev,
 			 * for other VM updates and moves.
 			 */
 			fence_owner = amdgpu_sync_get_owner(f);
+
+			/* CPU page table updates must wait for GPU VM
+			 * updates and moves touching the same PD/PTs,
+			 * but never for command submissions.
+			 */
+			if (owner == AMDGPU_FENCE_OWNER_VM_CPU) {
+				if (fence_owner != AMDGPU_FENCE_OWNER_VM &&
+				    fence_owner != AMDGPU_FENCE_OWNER_UNDEFINED)
+					continue;
+				goto sync;
+			}
+
 			if ((owner != AMDGPU_FENCE_OWNER_UNDEFINED) &&
 			    (fence_owner != AMDGPU_FENCE_OWNER_UNDEFINED) &&
 			    ((owner == AMDGPU_FENCE_OWNER_VM) !=
@@ -215,6 +227,7 @@ int amdgpu_sync_resv(struct amdgpu_device *adev,
 				continue;
 		}
 
+sync:
 		r = amdgpu_sync_fence(adev, sync, f);
 		if (r)
 			break;
@@ -2,66 +2,74 @@
 #define _AMDGPU_TRACE_FREEBSD_H_
 
 #include <drm/drmP.h>
+#include <drm/drm_trace_freebsd.h>
 #include "amdgpu.h"
 
 static inline void
 trace_amdgpu_cs_ioctl(struct amdgpu_job *job){
-	CTR1(KTR_DRM, "amdgpu_cs_ioctl %p", job);
+	DRM_TRACE3("amdgpu_cs_ioctl", job->ring->idx,
+	    job->base.s_fence->finished.seqno, job->num_ibs);
 }
 
 static inline void
 trace_amdgpu_cs(struct amdgpu_cs_parser *parser, int i){
-	CTR2(KTR_DRM, "amdgpu_cs %d %p", i, parser);
+	DRM_TRACE3("amdgpu_cs", parser->job->ring->idx, i,
+	    parser->job->ibs[i].length_dw);
 }
 
 static inline void
 trace_amdgpu_sched_run_job(struct amdgpu_job *job){
-	CTR1(KTR_DRM, "amdgpu_sched_run_job %p", job);
+	DRM_TRACE3("amdgpu_sched_run_job", job->ring->idx,
+	    job->base.s_fence->finished.seqno, job->num_ibs);
 }
 
 static inline void
-trace_amdgpu_bo_create(void *bo)
+trace_amdgpu_bo_create(struct amdgpu_bo *bo)
 {
-	CTR1(KTR_DRM, "amdgpu_bo_create %p", bo);
+	DRM_TRACE4("amdgpu_bo_create", (uintptr_t)bo, bo->tbo.num_pages,
+	    bo->prefered_domains, bo->flags);
 }
 
 static inline void
 trace_amdgpu_bo_list_set(void *a, void *b) {
-	CTR2(KTR_DRM, "amdgpu_bo_list_set %p %p", a, b);
+	DRM_TRACE2("amdgpu_bo_list_set", (uintptr_t)a, (uintptr_t)b);
 }
 
 #define	trace_amdgpu_vm_grab_id(vm, idx, job) \
-        CTR3(KTR_DRM, "amdgpu_vm_grab_id %p %u %p", (vm), (idx), (job));
+	DRM_TRACE4("amdgpu_vm_grab_id", (uintptr_t)(vm), (idx), \
+	    (job)->vm_id, (job)->vm_needs_flush)
 
 static inline void
 trace_amdgpu_vm_flush(uint64_t pd_addr, int idx, unsigned vm_id){
-	CTR3(KTR_DRM, "amdgpu_vm_flush %x %u %u", pd_addr, idx, vm_id);
+	DRM_TRACE3("amdgpu_vm_flush", pd_addr, idx, vm_id);
 }
 
 static inline void
 trace_amdgpu_vm_bo_unmap(struct amdgpu_bo_va * bo_va, struct amdgpu_bo_va_mapping * mapping){
-	CTR2(KTR_DRM, "amdgpu_vm_bo_unmap %p %p", bo_va, mapping);
+	DRM_TRACE4("amdgpu_vm_bo_unmap", (uintptr_t)bo_va->bo,
+	    mapping->it.start, mapping->it.last, mapping->flags);
 }
 
 static inline void
 trace_amdgpu_vm_bo_update(struct amdgpu_bo_va_mapping * mapping){
-	CTR1(KTR_DRM, "amdgpu_vm_bo_update %p", mapping);
+	DRM_TRACE3("amdgpu_vm_bo_update", mapping->it.start,
+	    mapping->it.last, mapping->flags);
 }
 
 static inline void
 trace_amdgpu_vm_set_page(uint64_t pe, uint64_t addr, unsigned count, uint32_t incr, uint32_t flags){
-	CTR5(KTR_DRM, "amdgpu_vm_set_page %x %x %u %u %x", pe, addr, count, incr, flags);
+	DRM_TRACE4("amdgpu_vm_set_page", pe, addr, count, flags);
 }
 
 static inline int
 trace_amdgpu_vm_bo_mapping_enabled(void){
-	CTR0(KTR_DRM, "amdgpu_vm_bo_mapping_enabled");
-	return (0);
+	return (drm_trace_enabled);
 }
 
 static inline void
 trace_amdgpu_vm_bo_mapping(struct amdgpu_bo_va_mapping * mapping){
-	CTR1(KTR_DRM, "amdgpu_vm_bo_mapping %p", mapping);
+	DRM_TRACE3("amdgpu_vm_bo_mapping", mapping->it.start,
+	    mapping->it.last, mapping->flags);
 }
 
 #define trace_amdgpu_mm_rreg(dev, reg, ret)	\
@@ -71,20 +79,15 @@ trace_amdgpu_vm_bo_mapping(struct amdgpu_bo_va_mapping * mapping){
 	CTR3(KTR_DRM, "amdgpu_mm_wreg %p %x %x", (dev), (reg), (x))
 
 #define trace_amdgpu_cs_bo_status(entries, size)	\
-	CTR2(KTR_DRM, "amdgpu_cs_bo_status entries %d size %d", (entries), (size))
+	DRM_TRACE2("amdgpu_cs_bo_status", (entries), (size))
 
 #define trace_amdgpu_ttm_bo_move(bo, new, old)	\
-	do {					\
-		u32 old_mem_type;	\
-		old_mem_type = (old);					\
-		CTR3(KTR_DRM, "amdgpu_ttm_bo_move %p new %d old %d", (bo), (new), (old_mem_type)); \
-	} while (0)
+	DRM_TRACE3("amdgpu_ttm_bo_move", (uintptr_t)(bo), (new), (old))
 
 #define trace_amdgpu_vm_set_ptes(pe, addr, count, incr, flags)	\
-	CTR5(KTR_DRM, "amdgpu_vm_set_ptes %lx %lx %u %u %x", pe, addr, count, incr, flags)
+	DRM_TRACE4("amdgpu_vm_set_ptes", (pe), (addr), (count), (flags))
 
 #define trace_amdgpu_vm_copy_ptes(pe, src, count)	\
-	CTR3(KTR_DRM, "amdgpu_vm_copy_ptes %lx %lx %u", pe, src, count)
+	DRM_TRACE3("amdgpu_vm_copy_ptes", (pe), (src), (count))
 
 #endif
-
@@ -260,6 +260,55 @@ static void amdgpu_move_null(struct ttm_buffer_object *bo,
 	new_mem->mm_node = NULL;
 }
 
+struct amdgpu_move_sample {
+	struct fence_cb		cb;
+	struct amdgpu_device	*adev;
+	u64			bytes;
+	s64			submit_ns;
+};
+
+/*
+ * Copies on the buffer funcs ring execute in order, so the time a copy really
+ * took is measured from the later of its submission and the completion of
+ * the copy before it.
+ */
+static void amdgpu_move_sample_cb(struct fence *f, struct fence_cb *cb)
+{
+	struct amdgpu_move_sample *s =
+		container_of(cb, struct amdgpu_move_sample, cb);
+	struct amdgpu_device *adev = s->adev;
+	s64 now = ktime_to_ns(ktime_get());
+	s64 start;
+
+	start = max(s->submit_ns, (s64)atomic64_read(&adev->mm_stats.last_move_ns));
+	atomic64_set(&adev->mm_stats.last_move_ns, now);
+	if (now > start) {
+		atomic64_add(s->bytes, &adev->mm_stats.sample_bytes);
+		atomic64_add(now - start, &adev->mm_stats.sample_ns);
+	}
+	kfree(s);
+}
+
+static void amdgpu_move_sample(struct amdgpu_device *adev,
+			       struct fence *fence, u64 bytes)
+{
+	struct amdgpu_move_sample *s;
+
+	/* a fixed migration rate was requested, nothing to measure */
+	if (amdgpu_moverate >= 0)
+		return;
+
+	s = kmalloc(sizeof(*s), GFP_KERNEL);
+	if (!s)
+		return;
+
+	s->adev = adev;
+	s->bytes = bytes;
+	s->submit_ns = ktime_to_ns(ktime_get());
+	if (fence_add_callback(fence, &s->cb, amdgpu_move_sample_cb))
+		kfree(s);
+}
+
 static int amdgpu_move_blit(struct ttm_buffer_object *bo,
 			bool evict, bool no_wait_gpu,
 			struct ttm_mem_reg *new_mem,
@@ -315,6 +364,8 @@ static int amdgpu_move_blit(struct ttm_buffer_object *bo,
 	if (r)
 		return r;
 
+	amdgpu_move_sample(adev, fence, (u64)new_mem->num_pages * PAGE_SIZE);
+
 	r = ttm_bo_pipeline_move(bo, fence, evict, new_mem);
 	fence_put(fence);
 	return r;
@@ -67,6 +67,10 @@ struct amdgpu_pte_update_params {
 		     uint32_t flags);
 	/* indicate update pt or its shadow */
 	bool shadow;
+	/* DMA addresses to use for mapping, CPU updates only */
+	dma_addr_t *pages_addr;
+	/* PTEs are written through a CPU mapping of the page tables */
+	bool cpu;
 };
 
 /**
@@ -612,6 +616,64 @@ static uint64_t amdgpu_vm_map_gart(const dma_addr_t *pages_addr, uint64_t addr)
 	return result;
 }
 
+/**
+ * amdgpu_vm_cpu_set_ptes - write the PTEs with the CPU
+ *
+ * @params: see amdgpu_pte_update_params definition
+ * @pe: kernel address of the page entry
+ * @addr: dst addr to write into pe
+ * @count: number of page entries to update
+ * @incr: increase next addr by incr bytes
+ * @flags: hw access flags
+ *
+ * Generates the PTEs in one pass and stores them directly into the CPU
+ * mapping of the page table.
+ */
+static void amdgpu_vm_cpu_set_ptes(struct amdgpu_pte_update_params *params,
+				   uint64_t pe, uint64_t addr,
+				   unsigned count, uint32_t incr,
+				   uint32_t flags)
+{
+	uint64_t __iomem *ptes = (uint64_t __iomem *)(uintptr_t)pe;
+	uint64_t value;
+	unsigned i;
+
+	trace_amdgpu_vm_set_ptes(pe, addr, count, incr, flags);
+
+	if (params->pages_addr) {
+		for (i = 0; i < count; i++, addr += incr) {
+			value = amdgpu_vm_map_gart(params->pages_addr, addr);
+			writeq(value | flags, &ptes[i]);
+		}
+	} else {
+		for (i = 0; i < count; i++, addr += incr)
+			writeq(addr | flags, &ptes[i]);
+	}
+}
+
+/**
+ * amdgpu_vm_cpu_flush - make CPU page table updates visible to the GPU
+ *
+ * @adev: amdgpu_device pointer
+ * @vm: requested vm
+ *
+ * Invalidates the TLBs of all VMIDs currently assigned to @vm.
+ */
+static void amdgpu_vm_cpu_flush(struct amdgpu_device *adev,
+				struct amdgpu_vm *vm)
+{
+	struct amdgpu_vm_id *id;
+	unsigned i;
+
+	mb();
+	for (i = 0; i < AMDGPU_MAX_RINGS; ++i) {
+		id = vm->ids[i];
+		if (id)
+			amdgpu_gart_flush_gpu_tlb(adev,
+						  id - adev->vm_manager.ids);
+	}
+}
+
 static int amdgpu_vm_update_pd_or_shadow(struct amdgpu_device *adev,
 					 struct amdgpu_vm *vm,
 					 bool shadow)
@@ -752,6 +814,16 @@ int amdgpu_vm_update_page_directory(struct amdgpu_device *adev,
 	return amdgpu_vm_update_pd_or_shadow(adev, vm, false);
 }
 
+/* address of a page table as seen by the update backend */
+static uint64_t amdgpu_vm_pt_addr(struct amdgpu_pte_update_params *params,
+				  struct amdgpu_bo *pt)
+{
+	if (params->cpu)
+		return (uint64_t)(uintptr_t)pt->kptr;
+
+	return amdgpu_bo_gpu_offset(pt);
+}
+
 /**
  * amdgpu_vm_update_ptes - make sure that page tables are valid
  *
@@ -792,7 +864,7 @@ static void amdgpu_vm_update_ptes(struct amdgpu_pte_update_params *params,
 	else
 		nptes = AMDGPU_VM_PTE_COUNT - (addr & mask);
 
-	cur_pe_start = amdgpu_bo_gpu_offset(pt);
+	cur_pe_start = amdgpu_vm_pt_addr(params, pt);
 	cur_pe_start += (addr & mask) * 8;
 	cur_nptes = nptes;
 	cur_dst = dst;
@@ -816,7 +888,7 @@ static void amdgpu_vm_update_ptes(struct amdgpu_pte_update_params *params,
 		else
 			nptes = AMDGPU_VM_PTE_COUNT - (addr & mask);
 
-		next_pe_start = amdgpu_bo_gpu_offset(pt);
+		next_pe_start = amdgpu_vm_pt_addr(params, pt);
 		next_pe_start += (addr & mask) * 8;
 
 		if ((cur_pe_start + 8 * cur_nptes) == next_pe_start &&
@@ -886,7 +958,7 @@ static void amdgpu_vm_frag_ptes(struct amdgpu_pte_update_params	*params,
 	uint64_t frag_end = end & ~(frag_align - 1);
 
 	/* system pages are non continuously */
-	if (params->src || !(flags & AMDGPU_PTE_VALID) ||
+	if (params->src || params->pages_addr || !(flags & AMDGPU_PTE_VALID) ||
 	    (frag_start >= frag_end)) {
 
 		amdgpu_vm_update_ptes(params, vm, start, end, dst, flags);
@@ -911,6 +983,78 @@ static void amdgpu_vm_frag_ptes(struct amdgpu_pte_update_params	*params,
 	}
 }
 
+/**
+ * amdgpu_vm_cpu_update_mapping - update a mapping using the CPU
+ *
+ * @adev: amdgpu_device pointer
+ * @exclusive: fence we need to sync to
+ * @pages_addr: DMA addresses to use for mapping
+ * @vm: requested vm
+ * @start: start of mapped range
+ * @last: last mapped entry
+ * @flags: flags for the entries
+ * @addr: addr to set the area to
+ *
+ * Write the page table entries between @start and @last directly, after
+ * waiting for everything the SDMA path would have synced to. The TLBs are
+ * flushed once per amdgpu_vm_bo_update()/amdgpu_vm_clear_freed() call,
+ * after all mappings handled by that call are written.
+ * Returns -EAGAIN if a page table can't be mapped and SDMA must be used.
+ */
+static int amdgpu_vm_cpu_update_mapping(struct amdgpu_device *adev,
+					struct fence *exclusive,
+					dma_addr_t *pages_addr,
+					struct amdgpu_vm *vm,
+					uint64_t start, uint64_t last,
+					uint32_t flags, uint64_t addr)
+{
+	void *owner = AMDGPU_FENCE_OWNER_VM_CPU;
+	struct amdgpu_pte_update_params params;
+	struct amdgpu_sync sync;
+	struct fence *f;
+	uint64_t pt_idx;
+	int r;
+
+	for (pt_idx = start >> amdgpu_vm_block_size;
+	     pt_idx <= (last >> amdgpu_vm_block_size); ++pt_idx) {
+		struct amdgpu_bo *pt = vm->page_tables[pt_idx].entry.robj;
+
+		if (amdgpu_bo_kmap(pt, NULL) ||
+		    (pt->shadow && amdgpu_bo_kmap(pt->shadow, NULL)))
+			return -EAGAIN;
+	}
+
+	/* sync to everything on unmapping */
+	if (!(flags & AMDGPU_PTE_VALID))
+		owner = AMDGPU_FENCE_OWNER_UNDEFINED;
+
+	amdgpu_sync_create(&sync);
+	r = amdgpu_sync_fence(adev, &sync, exclusive);
+	if (!r)
+		r = amdgpu_sync_resv(adev, &sync,
+				     vm->page_directory->tbo.resv, owner);
+	while (!r && (f = amdgpu_sync_get_fence(&sync))) {
+		r = fence_wait(f, false);
+		fence_put(f);
+	}
+	amdgpu_sync_free(&sync);
+	if (r)
+		return r;
+
+	memset(&params, 0, sizeof(params));
+	params.adev = adev;
+	params.pages_addr = pages_addr;
+	params.cpu = true;
+	params.func = amdgpu_vm_cpu_set_ptes;
+
+	params.shadow = true;
+	amdgpu_vm_frag_ptes(&params, vm, start, last + 1, addr, flags);
+	params.shadow = false;
+	amdgpu_vm_frag_ptes(&params, vm, start, last + 1, addr, flags);
+
+	return 0;
+}
+
 /**
  * amdgpu_vm_bo_update_mapping - update a mapping in the vm page table
  *
@@ -945,6 +1089,13 @@ static int amdgpu_vm_bo_update_mapping(struct amdgpu_device *adev,
 	struct fence *f = NULL;
 	int r;
 
+	if (vm->use_cpu_for_update) {
+		r = amdgpu_vm_cpu_update_mapping(adev, exclusive, pages_addr,
+						 vm, start, last, flags, addr);
+		if (r != -EAGAIN)
+			return r;
+	}
+
 	memset(&params, 0, sizeof(params));
 	params.adev = adev;
 	params.src = src;
@@ -1211,6 +1362,9 @@ int amdgpu_vm_bo_update(struct amdgpu_device *adev,
 		list_add(&bo_va->vm_status, &vm->cleared);
 	spin_unlock(&vm->status_lock);
 
+	if (vm->use_cpu_for_update)
+		amdgpu_vm_cpu_flush(adev, vm);
+
 	return 0;
 }
 
@@ -1229,7 +1383,8 @@ int amdgpu_vm_clear_freed(struct amdgpu_device *adev,
 			  struct amdgpu_vm *vm)
 {
 	struct amdgpu_bo_va_mapping *mapping;
-	int r;
+	bool flush = false;
+	int r = 0;
 
 	while (!list_empty(&vm->freed)) {
 		mapping = list_first_entry(&vm->freed,
@@ -1240,10 +1395,15 @@ int amdgpu_vm_clear_freed(struct amdgpu_device *adev,
 					       0, 0, NULL);
 		kfree(mapping);
 		if (r)
-			return r;
+			break;
 
+		flush = true;
 	}
-	return 0;
+
+	if (flush && vm->use_cpu_for_update)
+		amdgpu_vm_cpu_flush(adev, vm);
+
+	return r;
 
 }
 
@@ -1415,7 +1575,9 @@ int amdgpu_vm_bo_map(struct amdgpu_device *adev,
 		r = amdgpu_bo_create(adev, AMDGPU_VM_PTE_COUNT * 8,
 				     AMDGPU_GPU_PAGE_SIZE, true,
 				     AMDGPU_GEM_DOMAIN_VRAM,
-				     AMDGPU_GEM_CREATE_NO_CPU_ACCESS |
+				     (vm->use_cpu_for_update ?
+				      AMDGPU_GEM_CREATE_CPU_ACCESS_REQUIRED :
+				      AMDGPU_GEM_CREATE_NO_CPU_ACCESS) |
 				     AMDGPU_GEM_CREATE_SHADOW,
 				     NULL, resv, &pt);
 		if (r)
@@ -1600,6 +1762,10 @@ int amdgpu_vm_init(struct amdgpu_device *adev, struct amdgpu_vm *vm)
 	INIT_LIST_HEAD(&vm->cleared);
 	INIT_LIST_HEAD(&vm->freed);
 
+	/* CPU updates need every page table to be CPU accessible */
+	vm->use_cpu_for_update = amdgpu_vm_update_mode == 1 &&
+		adev->mc.visible_vram_size >= adev->mc.real_vram_size;
+
 	pd_size = amdgpu_vm_directory_size(adev);
 	pd_entries = amdgpu_vm_num_pdes(adev);
 
@@ -22,6 +22,7 @@
  * Author: Stanislaw Skowronek
  */
 
+#include <linux/ktime.h>
 #include <linux/module.h>
 #include <linux/sched.h>
 #include <linux/slab.h>
@@ -99,8 +100,34 @@ static void debug_print_spaces(int n)
 #define SDEBUG(...) do { } while (0)
 #endif
 
-static uint32_t atom_iio_execute(struct atom_context *ctx, int base,
-				 uint32_t index, uint32_t data)
+static inline struct atom_table_stats *atom_cur_stats(struct atom_context *ctx)
+{
+	if (!ctx->stats || ctx->cur_table < 0 ||
+	    ctx->cur_table >= ctx->num_tables)
+		return NULL;
+	return &ctx->stats[ctx->cur_table];
+}
+
+static void atom_trace_record(struct atom_context *ctx, int index, int type,
+			      ktime_t now, uint64_t duration_ns, int ret)
+{
+	struct atom_trace_entry *e;
+
+	if (!ctx->trace)
+		return;
+	e = &ctx->trace[ctx->trace_head];
+	e->timestamp_ns = ktime_to_ns(now);
+	e->duration_ns = duration_ns;
+	e->index = index;
+	e->type = type;
+	e->depth = ctx->depth;
+	e->ret = ret;
+	ctx->trace_head = (ctx->trace_head + 1) % ctx->trace_size;
+	ctx->trace_count++;
+}
+
+static uint32_t atom_iio_run(struct atom_context *ctx, int base,
+			     uint32_t index, uint32_t data)
 {
 	uint32_t temp = 0xCDCDCDCD;
 
@@ -171,6 +198,22 @@ static uint32_t atom_iio_execute(struct atom_context *ctx, int base,
 		}
 }
 
+static uint32_t atom_iio_execute(struct atom_context *ctx, int base,
+				 uint32_t index, uint32_t data)
+{
+	struct atom_table_stats *stats = atom_cur_stats(ctx);
+	ktime_t start;
+	uint32_t temp;
+
+	if (!stats)
+		return atom_iio_run(ctx, base, index, data);
+
+	start = ktime_get();
+	temp = atom_iio_run(ctx, base, index, data);
+	stats->iio_ns += ktime_to_ns(ktime_sub(ktime_get(), start));
+	return temp;
+}
+
 static uint32_t atom_get_src_int(atom_exec_context *ctx, uint8_t attr,
 				 int *ptr, uint32_t *saved, int print)
 {
@@ -658,14 +701,20 @@ static void atom_op_compare(atom_exec_context *ctx, int *ptr, int arg)
 
 static void atom_op_delay(atom_exec_context *ctx, int *ptr, int arg)
 {
+	struct atom_table_stats *stats = atom_cur_stats(ctx->ctx);
 	unsigned count = U8((*ptr)++);
+	ktime_t start;
+
 	SDEBUG("   count: %d\n", count);
+	start = ktime_get();
 	if (arg == ATOM_UNIT_MICROSEC)
 		udelay(count);
 	else if (!drm_can_sleep())
 		mdelay(count);
 	else
 		msleep(count);
+	if (stats)
+		stats->delay_ns += ktime_to_ns(ktime_sub(ktime_get(), start));
 }
 
 static void atom_op_div(atom_exec_context *ctx, int *ptr, int arg)
@@ -1208,6 +1257,10 @@ static int amdgpu_atom_execute_table_locked(struct atom_context *ctx, int index,
 	int len, ws, ps, ptr;
 	unsigned char op;
 	atom_exec_context ectx;
+	struct atom_table_stats *stats;
+	int saved_table;
+	ktime_t start, now;
+	uint64_t elapsed;
 	int ret = 0;
 
 	if (!base)
@@ -1220,6 +1273,13 @@ static int amdgpu_atom_execute_table_locked(struct atom_context *ctx, int index,
 
 	SDEBUG(">> execute %04X (len %d, WS %d, PS %d)\n", base, len, ws, ps);
 
+	saved_table = ctx->cur_table;
+	ctx->cur_table = index;
+	stats = atom_cur_stats(ctx);
+	start = ktime_get();
+	atom_trace_record(ctx, index, ATOM_TRACE_ENTER, start, 0, 0);
+	ctx->depth++;
+
 	ectx.ctx = ctx;
 	ectx.ps_shift = ps / 4;
 	ectx.start = base;
@@ -1245,6 +1305,8 @@ static int amdgpu_atom_execute_table_locked(struct atom_context *ctx, int index,
 			goto free;
 		}
 
+		if (stats)
+			stats->ops++;
 		if (op < ATOM_OP_CNT && op > 0)
 			opcode_table[op].func(&ectx, &ptr,
 					      opcode_table[op].arg);
@@ -1260,6 +1322,18 @@ static int amdgpu_atom_execute_table_locked(struct atom_context *ctx, int index,
 free:
 	if (ws)
 		kfree(ectx.ws);
+
+	ctx->depth--;
+	now = ktime_get();
+	elapsed = ktime_to_ns(ktime_sub(now, start));
+	if (stats) {
+		stats->calls++;
+		stats->total_ns += elapsed;
+		if (elapsed > stats->max_ns)
+			stats->max_ns = elapsed;
+	}
+	atom_trace_record(ctx, index, ATOM_TRACE_EXIT, now, elapsed, ret);
+	ctx->cur_table = saved_table;
 	return ret;
 }
 
@@ -1339,6 +1413,17 @@ struct atom_context *amdgpu_atom_parse(struct card_info *card, void *bios)
 
 	ctx->cmd_table = CU16(base + ATOM_ROM_CMD_PTR);
 	ctx->data_table = CU16(base + ATOM_ROM_DATA_PTR);
+	ctx->cur_table = -1;
+
+	/* the master command table header holds the size of the index list */
+	if (CU16(ctx->cmd_table) > 4)
+		ctx->num_tables = (CU16(ctx->cmd_table) - 4) / 2;
+	if (ctx->num_tables) {
+		ctx->stats = kcalloc(ctx->num_tables,
+				     sizeof(struct atom_table_stats), GFP_KERNEL);
+		if (!ctx->stats)
+			ctx->num_tables = 0;
+	}
 	atom_index_iio(ctx, CU16(ctx->data_table + ATOM_DATA_IIO_PTR) + 4);
 	if (!ctx->iio) {
 		amdgpu_atom_destroy(ctx);
@@ -1387,10 +1472,48 @@ int amdgpu_atom_asic_init(struct atom_context *ctx)
 
 void amdgpu_atom_destroy(struct atom_context *ctx)
 {
+	kfree(ctx->trace);
+	kfree(ctx->stats);
 	kfree(ctx->iio);
 	kfree(ctx);
 }
 
+/**
+ * amdgpu_atom_trace_alloc - set up the table entry/exit trace ring
+ *
+ * @ctx: atom context
+ * @entries: number of records to keep, 0 disables tracing
+ *
+ * Replaces any existing trace ring.  Returns 0 on success, -ENOMEM on
+ * failure.
+ */
+int amdgpu_atom_trace_alloc(struct atom_context *ctx, unsigned entries)
+{
+	struct atom_trace_entry *trace = NULL;
+
+	if (entries) {
+		trace = kcalloc(entries, sizeof(*trace), GFP_KERNEL);
+		if (!trace)
+			return -ENOMEM;
+	}
+
+	mutex_lock(&ctx->mutex);
+	kfree(ctx->trace);
+	ctx->trace = trace;
+	ctx->trace_size = entries;
+	ctx->trace_head = 0;
+	ctx->trace_count = 0;
+	mutex_unlock(&ctx->mutex);
+	return 0;
+}
+
+const char *amdgpu_atom_table_name(int index)
+{
+	if (index >= 0 && index < ATOM_TABLE_NAMES_CNT)
+		return atom_table_names[index];
+	return "?";
+}
+
 bool amdgpu_atom_parse_data_header(struct atom_context *ctx, int index,
 			    uint16_t * size, uint8_t * frev, uint8_t * crev,
 			    uint16_t * data_start)
@@ -122,6 +122,28 @@ struct card_info {
 	uint32_t (* pll_read)(struct card_info *, uint32_t);          /*  filled by driver */
 };
 
+/* per command table execution statistics, times in nanoseconds */
+struct atom_table_stats {
+	uint64_t calls;
+	uint64_t total_ns;
+	uint64_t max_ns;
+	uint64_t ops;
+	uint64_t delay_ns;
+	uint64_t iio_ns;
+};
+
+#define ATOM_TRACE_ENTER	0
+#define ATOM_TRACE_EXIT		1
+
+struct atom_trace_entry {
+	uint64_t timestamp_ns;
+	uint64_t duration_ns;	/* exit records only */
+	uint16_t index;
+	uint8_t type;
+	uint8_t depth;
+	int32_t ret;		/* exit records only */
+};
+
 struct atom_context {
 	struct card_info *card;
 	struct mutex mutex;
@@ -139,6 +161,16 @@ struct atom_context {
 	int io_mode;
 	uint32_t *scratch;
 	int scratch_size_bytes;
+
+	/* profiling, protected by mutex */
+	struct atom_table_stats *stats;
+	unsigned num_tables;
+	int cur_table;
+	unsigned depth;
+	struct atom_trace_entry *trace;
+	unsigned trace_size;
+	unsigned trace_head;
+	uint64_t trace_count;
 };
 
 extern int amdgpu_atom_debug;
@@ -152,6 +184,8 @@ bool amdgpu_atom_parse_data_header(struct atom_context *ctx, int index, uint16_t
 bool amdgpu_atom_parse_cmd_header(struct atom_context *ctx, int index,
 			   uint8_t *frev, uint8_t *crev);
 int amdgpu_atom_allocate_fb_scratch(struct atom_context *ctx);
+int amdgpu_atom_trace_alloc(struct atom_context *ctx, unsigned entries);
+const char *amdgpu_atom_table_name(int index);
 #include "atom-types.h"
 #include "atombios.h"
 #include "ObjectID.h"
@@ -342,6 +342,7 @@ static int update_queue(struct device_queue_manager *dqm, struct queue *q)
 {
 	int retval;
 	struct mqd_manager *mqd;
+	struct kfd_process_device *pdd;
 	bool prev_active = false;
 
 	BUG_ON(!dqm || !q || !q->mqd);
@@ -357,6 +358,10 @@ static int update_queue(struct device_queue_manager *dqm, struct queue *q)
 	if (q->properties.is_active)
 		prev_active = true;
 
+	pdd = kfd_get_process_device_data(dqm->dev, q->process);
+	if (pdd != NULL)
+		pm_invalidate_process(&pdd->qpd);
+
 	/*
 	 *
 	 * check active state vs. the previous state
@@ -415,6 +420,7 @@ static int register_process_nocpsch(struct device_queue_manager *dqm,
 	list_add(&n->list, &dqm->queues);
 
 	retval = dqm->ops_asic_specific.register_process(dqm, qpd);
+	pm_invalidate_process(qpd);
 
 	dqm->processes_count++;
 
@@ -443,6 +449,7 @@ static int unregister_process_nocpsch(struct device_queue_manager *dqm,
 		if (qpd == cur->qpd) {
 			list_del(&cur->list);
 			kfree(cur);
+			pm_release_process(qpd);
 			dqm->processes_count--;
 			goto out;
 		}
@@ -815,6 +822,7 @@ static int create_kernel_queue_cpsch(struct device_queue_manager *dqm,
 	list_add(&kq->list, &qpd->priv_queue_list);
 	dqm->queue_count++;
 	qpd->is_debug = true;
+	pm_invalidate_process(qpd);
 	execute_queues_cpsch(dqm, false);
 	mutex_unlock(&dqm->lock);
 
@@ -835,6 +843,7 @@ static void destroy_kernel_queue_cpsch(struct device_queue_manager *dqm,
 	list_del(&kq->list);
 	dqm->queue_count--;
 	qpd->is_debug = false;
+	pm_invalidate_process(qpd);
 	execute_queues_cpsch(dqm, false);
 	/*
 	 * Unconditionally decrement this counter, regardless of the queue's
@@ -894,6 +903,7 @@ static int create_queue_cpsch(struct device_queue_manager *dqm, struct queue *q,
 		goto out;
 
 	list_add(&q->list, &qpd->queues_list);
+	pm_invalidate_process(qpd);
 	if (q->properties.is_active) {
 		dqm->queue_count++;
 		retval = execute_queues_cpsch(dqm, false);
@@ -1071,6 +1081,7 @@ static int destroy_queue_cpsch(struct device_queue_manager *dqm,
 		dqm->sdma_queue_count--;
 
 	list_del(&q->list);
+	pm_invalidate_process(qpd);
 	if (q->properties.is_active)
 		dqm->queue_count--;
 
@@ -1157,6 +1168,8 @@ static bool set_cache_memory_policy(struct device_queue_manager *dqm,
 			alternate_aperture_base,
 			alternate_aperture_size);
 
+	pm_invalidate_process(qpd);
+
 	if ((sched_policy == KFD_SCHED_POLICY_NO_HWS) && (qpd->vmid != 0))
 		program_sh_mem_settings(dqm, qpd);
 
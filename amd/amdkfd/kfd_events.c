@@ -37,12 +37,12 @@
  * waiting on multiple events (any/all).
  * Instead of each event simply having a wait_queue with sleeping tasks, it
  * has a singly-linked list of tasks.
- * A thread that wants to sleep creates an array of these, one for each event
- * and adds one to each event's waiter chain.
+ * A thread that wants to sleep takes a kfd_event_wait holding an array of
+ * these, one for each event, and adds one to each event's waiter chain.
  */
 struct kfd_event_waiter {
 	struct list_head waiters;
-	struct task_struct *sleeping_task;
+	struct kfd_event_wait *wait;
 
 	/* Transitions to true when the event this belongs to is signaled. */
 	bool activated;
@@ -52,6 +52,31 @@ struct kfd_event_waiter {
 	uint32_t input_index;
 };
 
+/* Number of kfd_event_data copied in from user space at once. */
+#define KFD_EVENT_WAIT_BATCH	64
+/* Idle kfd_event_waits kept per process for reuse. */
+#define KFD_EVENT_WAIT_POOL_MAX	4
+
+/*
+ * One wait on a set of events.  activated_count is only incremented under
+ * the process event_mutex, and lets both the waiting thread and set_event
+ * check the wait-any/wait-all condition without scanning the waiters.
+ */
+struct kfd_event_wait {
+	/* On kfd_process.event_wait_pool while idle. */
+	struct list_head pool_list;
+	struct task_struct *sleeping_task;
+
+	atomic_t activated_count;
+	uint32_t num_events;
+	uint32_t capacity;
+	bool all;
+	bool has_memory_events;
+
+	struct kfd_event_data batch[KFD_EVENT_WAIT_BATCH];
+	struct kfd_event_waiter waiters[];
+};
+
 /*
  * Over-complicated pooled allocator for event notification slots.
  *
@@ -339,6 +364,8 @@ void kfd_event_init_process(struct kfd_process *p)
 	mutex_init(&p->event_mutex);
 	hash_init(p->events);
 	INIT_LIST_HEAD(&p->signal_event_pages);
+	INIT_LIST_HEAD(&p->event_wait_pool);
+	p->event_wait_pool_count = 0;
 	p->next_nonsignal_event_id = KFD_FIRST_NONSIGNAL_EVENT_ID;
 	p->signal_event_count = 0;
 }
@@ -387,10 +414,22 @@ static void shutdown_signal_pages(struct kfd_process *p)
 	}
 }
 
+static void shutdown_event_wait_pool(struct kfd_process *p)
+{
+	struct kfd_event_wait *wait, *tmp;
+
+	list_for_each_entry_safe(wait, tmp, &p->event_wait_pool, pool_list)
+		kfree(wait);
+
+	INIT_LIST_HEAD(&p->event_wait_pool);
+	p->event_wait_pool_count = 0;
+}
+
 void kfd_event_free_process(struct kfd_process *p)
 {
 	destroy_events(p);
 	shutdown_signal_pages(p);
+	shutdown_event_wait_pool(p);
 }
 
 static bool event_can_be_gpu_signaled(const struct kfd_event *ev)
@@ -474,6 +513,25 @@ int kfd_event_destroy(struct kfd_process *p, uint32_t event_id)
 	return ret;
 }
 
+/*
+ * Mark a waiter activated and return true if that completed its wait.
+ * A waiter is counted only once. Assumes that the process's event_mutex
+ * is locked.
+ */
+static bool activate_event_waiter(struct kfd_event_waiter *waiter)
+{
+	struct kfd_event_wait *wait = waiter->wait;
+	int count;
+
+	if (waiter->activated)
+		return false;
+
+	waiter->activated = true;
+	count = atomic_inc_return(&wait->activated_count);
+
+	return wait->all ? count == wait->num_events : count == 1;
+}
+
 static void set_event(struct kfd_event *ev)
 {
 	struct kfd_event_waiter *waiter;
@@ -483,12 +541,12 @@ static void set_event(struct kfd_event *ev)
 	ev->signaled = !ev->auto_reset || list_empty(&ev->waiters);
 
 	list_for_each_entry_safe(waiter, next, &ev->waiters, waiters) {
-		waiter->activated = true;
-
 		/* _init because free_waiters will call list_del */
 		list_del_init(&waiter->waiters);
 
-		wake_up_process(waiter->sleeping_task);
+		/* only wake the thread once its condition is met */
+		if (activate_event_waiter(waiter))
+			wake_up_process(waiter->wait->sleeping_task);
 	}
 }
 
@@ -599,22 +657,51 @@ void kfd_signal_event_interrupt(unsigned int pasid, uint32_t partial_id,
 	mutex_unlock(&p->mutex);
 }
 
-static struct kfd_event_waiter *alloc_event_waiters(uint32_t num_events)
+/*
+ * Take a wait from the process pool, or allocate one if none of the idle
+ * ones is large enough.  Assumes that the process's event_mutex is locked.
+ */
+static struct kfd_event_wait *alloc_event_wait(struct kfd_process *p,
+		uint32_t num_events, bool all)
 {
-	struct kfd_event_waiter *event_waiters;
+	struct kfd_event_wait *wait, *found = NULL;
 	uint32_t i;
 
-	event_waiters = kmalloc_array(num_events,
-					sizeof(struct kfd_event_waiter),
-					GFP_KERNEL);
+	list_for_each_entry(wait, &p->event_wait_pool, pool_list) {
+		if (wait->capacity >= num_events) {
+			found = wait;
+			break;
+		}
+	}
 
-	for (i = 0; (event_waiters) && (i < num_events) ; i++) {
-		INIT_LIST_HEAD(&event_waiters[i].waiters);
-		event_waiters[i].sleeping_task = current;
-		event_waiters[i].activated = false;
+	if (found) {
+		list_del(&found->pool_list);
+		p->event_wait_pool_count--;
+		wait = found;
+	} else {
+		wait = kmalloc(sizeof(*wait) +
+				num_events * sizeof(struct kfd_event_waiter),
+				GFP_KERNEL);
+		if (!wait)
+			return NULL;
+		wait->capacity = num_events;
 	}
 
-	return event_waiters;
+	INIT_LIST_HEAD(&wait->pool_list);
+	wait->sleeping_task = current;
+	atomic_set(&wait->activated_count, 0);
+	wait->num_events = num_events;
+	wait->all = all;
+	wait->has_memory_events = false;
+
+	for (i = 0; i < num_events; i++) {
+		INIT_LIST_HEAD(&wait->waiters[i].waiters);
+		wait->waiters[i].wait = wait;
+		wait->waiters[i].activated = false;
+		wait->waiters[i].event = NULL;
+	}
+
+	return wait;
 }
 
 static int init_event_waiter(struct kfd_process *p,
@@ -629,38 +716,62 @@ static int init_event_waiter(struct kfd_process *p,
 
 	waiter->event = ev;
 	waiter->input_index = input_index;
-	waiter->activated = ev->signaled;
+	if (ev->signaled)
+		activate_event_waiter(waiter);
 	ev->signaled = ev->signaled && !ev->auto_reset;
 
-	list_add(&waiter->waiters, &ev->waiters);
+	if (ev->type == KFD_EVENT_TYPE_MEMORY)
+		waiter->wait->has_memory_events = true;
+
+	/* Already activated waiters need no wakeup from set_event */
+	if (!waiter->activated)
+		list_add(&waiter->waiters, &ev->waiters);
 
 	return 0;
 }
 
-static bool test_event_condition(bool all, uint32_t num_events,
-				struct kfd_event_waiter *event_waiters)
+/*
+ * Copy the event IDs in from user space KFD_EVENT_WAIT_BATCH at a time and
+ * hook a waiter onto each event.
+ */
+static int init_event_waiters(struct kfd_process *p,
+		struct kfd_event_wait *wait,
+		struct kfd_event_data __user *events)
 {
-	uint32_t i;
-	uint32_t activated_count = 0;
-
-	for (i = 0; i < num_events; i++) {
-		if (event_waiters[i].activated) {
-			if (!all)
-				return true;
-
-			activated_count++;
+	uint32_t i, j, n;
+	int ret;
+
+	for (i = 0; i < wait->num_events; i += n) {
+		n = min_t(uint32_t, wait->num_events - i,
+				KFD_EVENT_WAIT_BATCH);
+
+		if (copy_from_user(wait->batch, &events[i],
+				n * sizeof(struct kfd_event_data)))
+			return -EFAULT;
+
+		for (j = 0; j < n; j++) {
+			ret = init_event_waiter(p, &wait->waiters[i + j],
+					wait->batch[j].event_id, i + j);
+			if (ret)
+				return ret;
 		}
 	}
 
-	return activated_count == num_events;
+	return 0;
+}
+
+static bool test_event_condition(struct kfd_event_wait *wait)
+{
+	uint32_t count = atomic_read(&wait->activated_count);
+
+	return wait->all ? count == wait->num_events : count > 0;
 }
 
 /*
  * Copy event specific data, if defined.
  * Currently only memory exception events have additional data to copy to user
  */
-static bool copy_signaled_event_data(uint32_t num_events,
-		struct kfd_event_waiter *event_waiters,
+static bool copy_signaled_event_data(struct kfd_event_wait *wait,
 		struct kfd_event_data __user *data)
 {
 	struct kfd_hsa_memory_exception_data *src;
@@ -669,8 +780,11 @@ static bool copy_signaled_event_data(uint32_t num_events,
 	struct kfd_event *event;
 	uint32_t i;
 
-	for (i = 0; i < num_events; i++) {
-		waiter = &event_waiters[i];
+	if (!wait->has_memory_events)
+		return true;
+
+	for (i = 0; i < wait->num_events; i++) {
+		waiter = &wait->waiters[i];
 		event = waiter->event;
 		if (waiter->activated && event->type == KFD_EVENT_TYPE_MEMORY) {
 			dst = &data[waiter->input_index].memory_exception_data;
@@ -705,14 +819,23 @@ static long user_timeout_to_jiffies(uint32_t user_timeout_ms)
 	return msecs_to_jiffies(user_timeout_ms) + 1;
 }
 
-static void free_waiters(uint32_t num_events, struct kfd_event_waiter *waiters)
+/*
+ * Unhook all waiters and return the wait to the process pool.
+ * Assumes that the process's event_mutex is locked.
+ */
+static void free_waiters(struct kfd_process *p, struct kfd_event_wait *wait)
 {
 	uint32_t i;
 
-	for (i = 0; i < num_events; i++)
-		list_del(&waiters[i].waiters);
+	for (i = 0; i < wait->num_events; i++)
+		list_del(&wait->waiters[i].waiters);
 
-	kfree(waiters);
+	if (p->event_wait_pool_count < KFD_EVENT_WAIT_POOL_MAX) {
+		list_add(&wait->pool_list, &p->event_wait_pool);
+		p->event_wait_pool_count++;
+	} else {
+		kfree(wait);
+	}
 }
 
 int kfd_wait_on_events(struct kfd_process *p,
@@ -722,35 +845,31 @@ int kfd_wait_on_events(struct kfd_process *p,
 {
 	struct kfd_event_data __user *events =
 			(struct kfd_event_data __user *) data;
-	uint32_t i;
 	int ret = 0;
-	struct kfd_event_waiter *event_waiters = NULL;
+	struct kfd_event_wait *wait = NULL;
 	long timeout = user_timeout_to_jiffies(user_timeout_ms);
 
 	mutex_lock(&p->event_mutex);
 
-	event_waiters = alloc_event_waiters(num_events);
-	if (!event_waiters) {
+	wait = alloc_event_wait(p, num_events, all);
+	if (!wait) {
 		ret = -ENOMEM;
 		goto fail;
 	}
 
-	for (i = 0; i < num_events; i++) {
-		struct kfd_event_data event_data;
-
-		if (copy_from_user(&event_data, &events[i],
-				sizeof(struct kfd_event_data)))
-			goto fail;
-
-		ret = init_event_waiter(p, &event_waiters[i],
-				event_data.event_id, i);
-		if (ret)
-			goto fail;
-	}
+	ret = init_event_waiters(p, wait, events);
+	if (ret)
+		goto fail;
 
 	mutex_unlock(&p->event_mutex);
 
 	while (true) {
+		/*
+		 * set_event only wakes us once the condition is met, so be
+		 * on the way to sleep before testing it.
+		 */
+		set_current_state(TASK_INTERRUPTIBLE);
+
 		if (fatal_signal_pending(current)) {
 			ret = -EINTR;
 			break;
@@ -769,9 +888,9 @@ int kfd_wait_on_events(struct kfd_process *p,
 			break;
 		}
 
-		if (test_event_condition(all, num_events, event_waiters)) {
-			if (copy_signaled_event_data(num_events,
-					event_waiters, events))
+		if (test_event_condition(wait)) {
+			__set_current_state(TASK_RUNNING);
+			if (copy_signaled_event_data(wait, events))
 				*wait_result = KFD_WAIT_COMPLETE;
 			else
 				*wait_result = KFD_WAIT_ERROR;
@@ -783,19 +902,19 @@ int kfd_wait_on_events(struct kfd_process *p,
 			break;
 		}
 
-		timeout = schedule_timeout_interruptible(timeout);
+		timeout = schedule_timeout(timeout);
 	}
 	__set_current_state(TASK_RUNNING);
 
 	mutex_lock(&p->event_mutex);
-	free_waiters(num_events, event_waiters);
+	free_waiters(p, wait);
 	mutex_unlock(&p->event_mutex);
 
 	return ret;
 
 fail:
-	if (event_waiters)
-		free_waiters(num_events, event_waiters);
+	if (wait)
+		free_waiters(p, wait);
 
 	mutex_unlock(&p->event_mutex);
 
@@ -95,6 +95,7 @@ static int pm_allocate_runlist_ib(struct packet_manager *pm,
 				unsigned int *rl_buffer_size,
 				bool *is_over_subscription)
 {
+	unsigned int idx;
 	int retval;
 
 	BUG_ON(!pm);
@@ -103,20 +104,35 @@ static int pm_allocate_runlist_ib(struct packet_manager *pm,
 
 	pm_calc_rlib_size(pm, rl_buffer_size, is_over_subscription);
 
-	retval = kfd_gtt_sa_allocate(pm->dqm->dev, *rl_buffer_size,
-					&pm->ib_buffer_obj);
+	/*
+	 * Alternate between two IBs so the runlist the HWS ran last is never
+	 * rewritten in place, and keep them around while they are big enough.
+	 */
+	idx = pm->ib_index ^ 1;
+	if (pm->ib_buffers[idx] != NULL &&
+	    pm->ib_sizes[idx] < *rl_buffer_size) {
+		kfd_gtt_sa_free(pm->dqm->dev, pm->ib_buffers[idx]);
+		pm->ib_buffers[idx] = NULL;
+	}
 
-	if (retval != 0) {
-		pr_err("kfd: failed to allocate runlist IB\n");
-		return retval;
+	if (pm->ib_buffers[idx] == NULL) {
+		retval = kfd_gtt_sa_allocate(pm->dqm->dev, *rl_buffer_size,
+					&pm->ib_buffers[idx]);
+		if (retval != 0) {
+			pr_err("kfd: failed to allocate runlist IB\n");
+			return retval;
+		}
+		pm->ib_sizes[idx] = *rl_buffer_size;
 	}
 
+	pm->ib_index = idx;
+	pm->ib_buffer_obj = pm->ib_buffers[idx];
+
 	*(void **)rl_buffer = pm->ib_buffer_obj->cpu_ptr;
 	*rl_gpu_buffer = pm->ib_buffer_obj->gpu_addr;
 
-	memset(*rl_buffer, 0, *rl_buffer_size);
 	pm->allocated = true;
-	return retval;
+	return 0;
 }
 
 static int pm_create_runlist(struct packet_manager *pm, uint32_t *buffer,
@@ -309,6 +325,121 @@ static int pm_create_map_queue(struct packet_manager *pm, uint32_t *buffer,
 	return 0;
 }
 
+/*
+ * Regenerate the map_process and map_queues packets of one process into
+ * its cached fragment.  The fragment stays valid until one of the
+ * dqm paths that changes the process or its queues calls
+ * pm_invalidate_process().
+ */
+static int pm_build_process_fragment(struct packet_manager *pm,
+				struct qcm_process_device *qpd)
+{
+	unsigned int size, wptr;
+	struct kernel_queue *kq;
+	struct queue *q;
+	uint32_t *frag;
+	int retval;
+
+	size = sizeof(struct pm4_map_process);
+	list_for_each_entry(kq, &qpd->priv_queue_list, list)
+		if (kq->queue->properties.is_active)
+			size += sizeof(struct pm4_map_queues);
+	list_for_each_entry(q, &qpd->queues_list, list)
+		if (q->properties.is_active)
+			size += sizeof(struct pm4_map_queues);
+
+	if (size > qpd->rl_fragment_alloc) {
+		frag = kmalloc(size, GFP_KERNEL);
+		if (frag == NULL)
+			return -ENOMEM;
+		kfree(qpd->rl_fragment);
+		qpd->rl_fragment = frag;
+		qpd->rl_fragment_alloc = size;
+	}
+
+	frag = qpd->rl_fragment;
+	memset(frag, 0, size);
+	wptr = 0;
+
+	retval = pm_create_map_process(pm, &frag[wptr], qpd);
+	if (retval != 0)
+		return retval;
+
+	inc_wptr(&wptr, sizeof(struct pm4_map_process), size);
+
+	list_for_each_entry(kq, &qpd->priv_queue_list, list) {
+		if (!kq->queue->properties.is_active)
+			continue;
+
+		pr_debug("kfd: static_queue, mapping kernel q %d, is debug status %d\n",
+			kq->queue->queue, qpd->is_debug);
+
+		if (pm->dqm->dev->device_info->asic_family ==
+				CHIP_CARRIZO)
+			retval = pm_create_map_queue_vi(pm,
+					&frag[wptr],
+					kq->queue,
+					qpd->is_debug);
+		else
+			retval = pm_create_map_queue(pm,
+					&frag[wptr],
+					kq->queue,
+					qpd->is_debug);
+		if (retval != 0)
+			return retval;
+
+		inc_wptr(&wptr, sizeof(struct pm4_map_queues), size);
+	}
+
+	list_for_each_entry(q, &qpd->queues_list, list) {
+		if (!q->properties.is_active)
+			continue;
+
+		pr_debug("kfd: static_queue, mapping user queue %d, is debug status %d\n",
+			q->queue, qpd->is_debug);
+
+		if (pm->dqm->dev->device_info->asic_family ==
+				CHIP_CARRIZO)
+			retval = pm_create_map_queue_vi(pm,
+					&frag[wptr],
+					q,
+					qpd->is_debug);
+		else
+			retval = pm_create_map_queue(pm,
+					&frag[wptr],
+					q,
+					qpd->is_debug);
+
+		if (retval != 0)
+			return retval;
+
+		inc_wptr(&wptr, sizeof(struct pm4_map_queues), size);
+	}
+
+	qpd->rl_fragment_size = size;
+	qpd->rl_fragment_dirty = false;
+
+	return 0;
+}
+
+void pm_invalidate_process(struct qcm_process_device *qpd)
+{
+	BUG_ON(!qpd);
+
+	qpd->rl_fragment_dirty = true;
+}
+
+void pm_release_process(struct qcm_process_device *qpd)
+{
+	BUG_ON(!qpd);
+
+	kfree(qpd->rl_fragment);
+	qpd->rl_fragment = NULL;
+	qpd->rl_fragment_size = 0;
+	qpd->rl_fragment_alloc = 0;
+	qpd->rl_fragment_dirty = false;
+}
+
 static int pm_create_runlist_ib(struct packet_manager *pm,
 				struct list_head *queues,
 				uint64_t *rl_gpu_addr,
@@ -316,16 +447,14 @@ static int pm_create_runlist_ib(struct packet_manager *pm,
 {
 	unsigned int alloc_size_bytes;
 	unsigned int *rl_buffer, rl_wptr, i;
-	int retval, proccesses_mapped;
+	int retval, proccesses_mapped, processes_rebuilt;
 	struct device_process_node *cur;
 	struct qcm_process_device *qpd;
-	struct queue *q;
-	struct kernel_queue *kq;
 	bool is_over_subscription;
 
 	BUG_ON(!pm || !queues || !rl_size_bytes || !rl_gpu_addr);
 
-	rl_wptr = retval = proccesses_mapped = 0;
+	rl_wptr = retval = proccesses_mapped = processes_rebuilt = 0;
 
 	retval = pm_allocate_runlist_ib(pm, &rl_buffer, rl_gpu_addr,
 				&alloc_size_bytes, &is_over_subscription);
@@ -338,79 +467,43 @@ static int pm_create_runlist_ib(struct packet_manager *pm,
 	pr_debug("kfd: building runlist ib process count: %d queues count %d\n",
 		pm->dqm->processes_count, pm->dqm->queue_count);
 
-	/* build the run list ib packet */
+	/* splice the per process fragments into the run list ib */
 	list_for_each_entry(cur, queues, list) {
 		qpd = cur->qpd;
-		/* build map process packet */
 		if (proccesses_mapped >= pm->dqm->processes_count) {
 			pr_debug("kfd: not enough space left in runlist IB\n");
 			pm_release_ib(pm);
 			return -ENOMEM;
 		}
 
-		retval = pm_create_map_process(pm, &rl_buffer[rl_wptr], qpd);
-		if (retval != 0)
-			return retval;
-
-		proccesses_mapped++;
-		inc_wptr(&rl_wptr, sizeof(struct pm4_map_process),
-				alloc_size_bytes);
-
-		list_for_each_entry(kq, &qpd->priv_queue_list, list) {
-			if (!kq->queue->properties.is_active)
-				continue;
-
-			pr_debug("kfd: static_queue, mapping kernel q %d, is debug status %d\n",
-				kq->queue->queue, qpd->is_debug);
-
-			if (pm->dqm->dev->device_info->asic_family ==
-					CHIP_CARRIZO)
-				retval = pm_create_map_queue_vi(pm,
-						&rl_buffer[rl_wptr],
-						kq->queue,
-						qpd->is_debug);
-			else
-				retval = pm_create_map_queue(pm,
-						&rl_buffer[rl_wptr],
-						kq->queue,
-						qpd->is_debug);
-			if (retval != 0)
+		if (qpd->rl_fragment == NULL || qpd->rl_fragment_dirty) {
+			retval = pm_build_process_fragment(pm, qpd);
+			if (retval != 0) {
+				pm_release_ib(pm);
 				return retval;
-
-			inc_wptr(&rl_wptr,
-				sizeof(struct pm4_map_queues),
-				alloc_size_bytes);
+			}
+			processes_rebuilt++;
 		}
 
-		list_for_each_entry(q, &qpd->queues_list, list) {
-			if (!q->properties.is_active)
-				continue;
-
-			pr_debug("kfd: static_queue, mapping user queue %d, is debug status %d\n",
-				q->queue, qpd->is_debug);
-
-			if (pm->dqm->dev->device_info->asic_family ==
-					CHIP_CARRIZO)
-				retval = pm_create_map_queue_vi(pm,
-						&rl_buffer[rl_wptr],
-						q,
-						qpd->is_debug);
-			else
-				retval = pm_create_map_queue(pm,
-						&rl_buffer[rl_wptr],
-						q,
-						qpd->is_debug);
-
-			if (retval != 0)
-				return retval;
-
-			inc_wptr(&rl_wptr,
-				sizeof(struct pm4_map_queues),
-				alloc_size_bytes);
+		if (rl_wptr * sizeof(uint32_t) + qpd->rl_fragment_size >
+				alloc_size_bytes) {
+			pr_debug("kfd: not enough space left in runlist IB\n");
+			pm_release_ib(pm);
+			return -ENOMEM;
 		}
+
+		memcpy(&rl_buffer[rl_wptr], qpd->rl_fragment,
+			qpd->rl_fragment_size);
+		proccesses_mapped++;
+		inc_wptr(&rl_wptr, qpd->rl_fragment_size, alloc_size_bytes);
 	}
 
-	pr_debug("kfd: finished map process and queues to runlist\n");
+	pr_debug("kfd: finished map process and queues to runlist, %d of %d processes rebuilt\n",
+		processes_rebuilt, proccesses_mapped);
+
+	/* the IB is reused, clear whatever the fragments did not cover */
+	memset(&rl_buffer[rl_wptr], 0,
+		alloc_size_bytes - rl_wptr * sizeof(uint32_t));
 
 	if (is_over_subscription)
 		pm_create_runlist(pm, &rl_buffer[rl_wptr], *rl_gpu_addr,
@@ -435,14 +528,28 @@ int pm_init(struct packet_manager *pm, struct device_queue_manager *dqm)
 		return -ENOMEM;
 	}
 	pm->allocated = false;
+	pm->ib_buffer_obj = NULL;
+	pm->ib_buffers[0] = pm->ib_buffers[1] = NULL;
+	pm->ib_sizes[0] = pm->ib_sizes[1] = 0;
+	pm->ib_index = 0;
 
 	return 0;
 }
 
 void pm_uninit(struct packet_manager *pm)
 {
+	int i;
+
 	BUG_ON(!pm);
 
+	for (i = 0; i < ARRAY_SIZE(pm->ib_buffers); i++) {
+		if (pm->ib_buffers[i] != NULL)
+			kfd_gtt_sa_free(pm->dqm->dev, pm->ib_buffers[i]);
+		pm->ib_buffers[i] = NULL;
+	}
+	pm->ib_buffer_obj = NULL;
+	pm->allocated = false;
+
 	mutex_destroy(&pm->lock);
 	kernel_queue_uninit(pm->priv_queue);
 }
@@ -663,10 +770,8 @@ void pm_release_ib(struct packet_manager *pm)
 {
 	BUG_ON(!pm);
 
+	/* the IB itself is kept for reuse and freed by pm_uninit */
 	mutex_lock(&pm->lock);
-	if (pm->allocated) {
-		kfd_gtt_sa_free(pm->dqm->dev, pm->ib_buffer_obj);
-		pm->allocated = false;
-	}
+	pm->allocated = false;
 	mutex_unlock(&pm->lock);
 }
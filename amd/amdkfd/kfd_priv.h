@@ -439,6 +439,15 @@ struct qcm_process_device {
 	uint32_t gds_size;
 	uint32_t num_gws;
 	uint32_t num_oac;
+
+	/*
+	 * Cached map_process and map_queues packets of this process, spliced
+	 * into the runlist IB and only regenerated when marked dirty.
+	 */
+	uint32_t *rl_fragment;
+	unsigned int rl_fragment_size;
+	unsigned int rl_fragment_alloc;
+	bool rl_fragment_dirty;
 };
 
 /* Data that is per-process-per device. */
@@ -527,6 +536,9 @@ struct kfd_process {
 								event_pages */
 	u32 next_nonsignal_event_id;
 	size_t signal_event_count;
+	/* Idle struct kfd_event_wait kept for reuse, by pool_list. */
+	struct list_head event_wait_pool;
+	unsigned int event_wait_pool_count;
 };
 
 /**
@@ -679,6 +691,10 @@ struct packet_manager {
 	struct mutex lock;
 	bool allocated;
 	struct kfd_mem_obj *ib_buffer_obj;
+	/* double-buffered runlist IBs, ib_buffer_obj is the current one */
+	struct kfd_mem_obj *ib_buffers[2];
+	unsigned int ib_sizes[2];
+	unsigned int ib_index;
 };
 
 int pm_init(struct packet_manager *pm, struct device_queue_manager *dqm);
@@ -695,6 +711,8 @@ int pm_send_unmap_queue(struct packet_manager *pm, enum kfd_queue_type type,
 			unsigned int sdma_engine);
 
 void pm_release_ib(struct packet_manager *pm);
+void pm_invalidate_process(struct qcm_process_device *qpd);
+void pm_release_process(struct qcm_process_device *qpd);
 
 uint64_t kfd_get_number_elems(struct kfd_dev *kfd);
 phys_addr_t kfd_get_process_doorbells(struct kfd_dev *dev,
@@ -178,6 +178,7 @@ static void kfd_process_wq_release(struct work_struct *work)
 		amd_iommu_unbind_pasid(pdd->dev->pdev, p->pasid);
 		list_del(&pdd->per_device_list);
 
+		pm_release_process(&pdd->qpd);
 		kfree(pdd);
 	}
 
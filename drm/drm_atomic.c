@@ -1596,15 +1596,102 @@ void drm_atomic_clean_old_fb(struct drm_device *dev,
 }
 EXPORT_SYMBOL(drm_atomic_clean_old_fb);
 
-int drm_mode_atomic_ioctl(struct drm_device *dev,
-			  void *data, struct drm_file *file_priv)
+/*
+ * Copy the object, property count, property id and value arrays of an atomic
+ * ioctl in one go, instead of faulting them in one element at a time while
+ * walking the objects. The id arrays share one allocation, the values another.
+ *
+ * The sizes come straight from userspace, so cap them. Objects and properties
+ * may legitimately be repeated (the last value wins), so the caps are far
+ * above anything a real device needs rather than derived from its objects.
+ */
+#define DRM_MODE_ATOMIC_MAX_OBJS	(1 << 12)
+#define DRM_MODE_ATOMIC_MAX_PROPS	(1 << 16)
+
+static int drm_mode_atomic_copy_args(struct drm_mode_atomic *arg,
+				     uint32_t **ids, uint64_t **values,
+				     unsigned int *total_props)
 {
-	struct drm_mode_atomic *arg = data;
 	uint32_t __user *objs_ptr = (uint32_t __user *)(unsigned long)(arg->objs_ptr);
 	uint32_t __user *count_props_ptr = (uint32_t __user *)(unsigned long)(arg->count_props_ptr);
 	uint32_t __user *props_ptr = (uint32_t __user *)(unsigned long)(arg->props_ptr);
 	uint64_t __user *prop_values_ptr = (uint64_t __user *)(unsigned long)(arg->prop_values_ptr);
-	unsigned int copied_objs, copied_props;
+	uint32_t *buf, *count_props;
+	uint64_t *vals = NULL;
+	uint64_t nobjs = arg->count_objs;
+	uint64_t nprops = 0;
+	uint64_t i;
+
+	*ids = NULL;
+	*values = NULL;
+	*total_props = 0;
+
+	if (nobjs == 0)
+		return 0;
+
+	if (nobjs > DRM_MODE_ATOMIC_MAX_OBJS)
+		return -EINVAL;
+
+	buf = drm_malloc_ab(2 * nobjs, sizeof(*buf));
+	if (!buf)
+		return -ENOMEM;
+
+	if (copy_from_user(buf, objs_ptr, nobjs * sizeof(*buf)) ||
+	    copy_from_user(buf + nobjs, count_props_ptr,
+			   nobjs * sizeof(*buf))) {
+		drm_free_large(buf);
+		return -EFAULT;
+	}
+
+	count_props = buf + nobjs;
+	for (i = 0; i < nobjs; i++)
+		nprops += count_props[i];
+
+	if (nprops > DRM_MODE_ATOMIC_MAX_PROPS) {
+		drm_free_large(buf);
+		return -EINVAL;
+	}
+
+	if (nprops) {
+		uint32_t *tmp;
+
+		tmp = drm_malloc_ab(2 * nobjs + nprops, sizeof(*buf));
+		vals = drm_malloc_ab(nprops, sizeof(*vals));
+		if (!tmp || !vals) {
+			drm_free_large(tmp);
+			drm_free_large(vals);
+			drm_free_large(buf);
+			return -ENOMEM;
+		}
+
+		memcpy(tmp, buf, 2 * nobjs * sizeof(*buf));
+		drm_free_large(buf);
+		buf = tmp;
+
+		if (copy_from_user(buf + 2 * nobjs, props_ptr,
+				   nprops * sizeof(*buf)) ||
+		    copy_from_user(vals, prop_values_ptr,
+				   nprops * sizeof(*vals))) {
+			drm_free_large(vals);
+			drm_free_large(buf);
+			return -EFAULT;
+		}
+	}
+
+	*ids = buf;
+	*values = vals;
+	*total_props = nprops;
+
+	return 0;
+}
+
+int drm_mode_atomic_ioctl(struct drm_device *dev,
+			  void *data, struct drm_file *file_priv)
+{
+	struct drm_mode_atomic *arg = data;
+	uint32_t *ids, *objs, *count_props, *props;
+	uint64_t *prop_values;
+	unsigned int copied_props, total_props;
 	struct drm_atomic_state *state;
 	struct drm_modeset_acquire_ctx ctx;
 	struct drm_plane *plane;
@@ -1640,30 +1727,34 @@ int drm_mode_atomic_ioctl(struct drm_device *dev,
 			(arg->flags & DRM_MODE_PAGE_FLIP_EVENT))
 		return -EINVAL;
 
+	ret = drm_mode_atomic_copy_args(arg, &ids, &prop_values, &total_props);
+	if (ret)
+		return ret;
+
+	objs = ids;
+	count_props = ids + arg->count_objs;
+	props = ids + 2 * arg->count_objs;
+
 	drm_modeset_acquire_init(&ctx, 0);
 
 	state = drm_atomic_state_alloc(dev);
-	if (!state)
+	if (!state) {
+		drm_free_large(prop_values);
+		drm_free_large(ids);
 		return -ENOMEM;
+	}
 
 	state->acquire_ctx = &ctx;
 	state->allow_modeset = !!(arg->flags & DRM_MODE_ATOMIC_ALLOW_MODESET);
 
 retry:
 	plane_mask = 0;
-	copied_objs = 0;
 	copied_props = 0;
 
 	for (i = 0; i < arg->count_objs; i++) {
-		uint32_t obj_id, count_props;
 		struct drm_mode_object *obj;
 
-		if (get_user(obj_id, objs_ptr + copied_objs)) {
-			ret = -EFAULT;
-			goto out;
-		}
-
-		obj = drm_mode_object_find(dev, obj_id, DRM_MODE_OBJECT_ANY);
+		obj = drm_mode_object_find(dev, objs[i], DRM_MODE_OBJECT_ANY);
 		if (!obj) {
 			ret = -ENOENT;
 			goto out;
@@ -1675,41 +1766,18 @@ retry:
 			goto out;
 		}
 
-		if (get_user(count_props, count_props_ptr + copied_objs)) {
-			drm_mode_object_unreference(obj);
-			ret = -EFAULT;
-			goto out;
-		}
-
-		copied_objs++;
-
-		for (j = 0; j < count_props; j++) {
-			uint32_t prop_id;
-			uint64_t prop_value;
+		for (j = 0; j < count_props[i]; j++) {
 			struct drm_property *prop;
 
-			if (get_user(prop_id, props_ptr + copied_props)) {
-				drm_mode_object_unreference(obj);
-				ret = -EFAULT;
-				goto out;
-			}
-
-			prop = drm_mode_obj_find_prop_id(obj, prop_id);
+			prop = drm_mode_obj_find_prop_id(obj, props[copied_props]);
 			if (!prop) {
 				drm_mode_object_unreference(obj);
 				ret = -ENOENT;
 				goto out;
 			}
 
-			if (copy_from_user(&prop_value,
-					   prop_values_ptr + copied_props,
-					   sizeof(prop_value))) {
-				drm_mode_object_unreference(obj);
-				ret = -EFAULT;
-				goto out;
-			}
-
-			ret = atomic_set_prop(state, obj, prop, prop_value);
+			ret = atomic_set_prop(state, obj, prop,
+					      prop_values[copied_props]);
 			if (ret) {
 				drm_mode_object_unreference(obj);
 				goto out;
@@ -1718,7 +1786,7 @@ retry:
 			copied_props++;
 		}
 
-		if (obj->type == DRM_MODE_OBJECT_PLANE && count_props &&
+		if (obj->type == DRM_MODE_OBJECT_PLANE && count_props[i] &&
 		    !(arg->flags & DRM_MODE_ATOMIC_TEST_ONLY)) {
 			plane = obj_to_plane(obj);
 			plane_mask |= (1 << drm_plane_index(plane));
@@ -1784,5 +1852,8 @@ out:
 	drm_modeset_drop_locks(&ctx);
 	drm_modeset_acquire_fini(&ctx);
 
+	drm_free_large(prop_values);
+	drm_free_large(ids);
+
 	return ret;
 }
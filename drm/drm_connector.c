@@ -348,6 +348,8 @@ void drm_connector_cleanup(struct drm_connector *connector)
 			  connector->index);
 
 	kfree(connector->display_info.bus_formats);
+	kfree(connector->edid_cache);
+	connector->edid_cache = NULL;
 	drm_mode_object_unregister(dev, &connector->base);
 	kfree(connector->name);
 	connector->name = NULL;
@@ -233,6 +233,72 @@ unlock:
 	return ret;
 }
 
+static bool drm_dp_dpcd_cacheable(struct drm_dp_aux *aux, unsigned int offset,
+				  size_t size)
+{
+	return aux->dpcd_cache_enabled && size > 0 &&
+		offset < DP_DPCD_CACHE_SIZE &&
+		size <= DP_DPCD_CACHE_SIZE - offset;
+}
+
+static bool drm_dp_dpcd_cache_lookup(struct drm_dp_aux *aux,
+				     unsigned int offset, void *buffer,
+				     size_t size, unsigned *seqno)
+{
+	unsigned int i;
+	bool hit = true;
+
+	mutex_lock(&aux->hw_mutex);
+	for (i = offset; i < offset + size; i++) {
+		if (!test_bit(i, aux->dpcd_cache_valid)) {
+			hit = false;
+			break;
+		}
+	}
+	if (hit) {
+		memcpy(buffer, &aux->dpcd_cache[offset], size);
+		aux->dpcd_cache_hits++;
+	} else {
+		aux->dpcd_cache_misses++;
+	}
+	*seqno = aux->dpcd_cache_seqno;
+	mutex_unlock(&aux->hw_mutex);
+
+	return hit;
+}
+
+static void drm_dp_dpcd_cache_fill(struct drm_dp_aux *aux, unsigned int offset,
+				   const void *buffer, size_t size,
+				   unsigned seqno)
+{
+	unsigned int i;
+
+	mutex_lock(&aux->hw_mutex);
+	if (aux->dpcd_cache_seqno == seqno) {
+		memcpy(&aux->dpcd_cache[offset], buffer, size);
+		for (i = offset; i < offset + size; i++)
+			__set_bit(i, aux->dpcd_cache_valid);
+	}
+	mutex_unlock(&aux->hw_mutex);
+}
+
+/**
+ * drm_dp_dpcd_cache_flush() - drop all cached DPCD capability registers
+ * @aux: DisplayPort AUX channel
+ *
+ * Drivers which set &drm_dp_aux.dpcd_cache_enabled must call this whenever
+ * the sink may have been replaced or reconfigured, most notably on long HPD
+ * pulses. The next read of each capability register goes to the sink again.
+ */
+void drm_dp_dpcd_cache_flush(struct drm_dp_aux *aux)
+{
+	mutex_lock(&aux->hw_mutex);
+	memset(aux->dpcd_cache_valid, 0, sizeof(aux->dpcd_cache_valid));
+	aux->dpcd_cache_seqno++;
+	mutex_unlock(&aux->hw_mutex);
+}
+EXPORT_SYMBOL(drm_dp_dpcd_cache_flush);
+
 /**
  * drm_dp_dpcd_read() - read a series of bytes from the DPCD
  * @aux: DisplayPort AUX channel
@@ -246,12 +312,22 @@ unlock:
  * function returns -EPROTO. Errors from the underlying AUX channel transfer
  * function, with the exception of -EBUSY (which causes the transaction to
  * be retried), are propagated to the caller.
+ *
+ * If &drm_dp_aux.dpcd_cache_enabled is set, reads which fall entirely within
+ * the receiver capability field are served from the cache when possible,
+ * without any AUX transaction.
  */
 ssize_t drm_dp_dpcd_read(struct drm_dp_aux *aux, unsigned int offset,
 			 void *buffer, size_t size)
 {
+	bool cacheable = drm_dp_dpcd_cacheable(aux, offset, size);
+	unsigned seqno = 0;
 	int ret;
 
+	if (cacheable &&
+	    drm_dp_dpcd_cache_lookup(aux, offset, buffer, size, &seqno))
+		return size;
+
 	/*
 	 * HP ZR24w corrupts the first DPCD access after entering power save
 	 * mode. Eg. on a read, the entire buffer will be filled with the same
@@ -269,8 +345,12 @@ ssize_t drm_dp_dpcd_read(struct drm_dp_aux *aux, unsigned int offset,
 	if (ret != 1)
 		return ret;
 
-	return drm_dp_dpcd_access(aux, DP_AUX_NATIVE_READ, offset, buffer,
-				  size);
+	ret = drm_dp_dpcd_access(aux, DP_AUX_NATIVE_READ, offset, buffer,
+				 size);
+	if (cacheable && ret == size)
+		drm_dp_dpcd_cache_fill(aux, offset, buffer, size, seqno);
+
+	return ret;
 }
 EXPORT_SYMBOL(drm_dp_dpcd_read);
 
@@ -291,6 +371,13 @@ EXPORT_SYMBOL(drm_dp_dpcd_read);
 ssize_t drm_dp_dpcd_write(struct drm_dp_aux *aux, unsigned int offset,
 			  void *buffer, size_t size)
 {
+	/*
+	 * The capability field is read-only, but don't trust sinks (or
+	 * userspace poking through the aux device) to agree.
+	 */
+	if (aux->dpcd_cache_enabled && offset < DP_DPCD_CACHE_SIZE)
+		drm_dp_dpcd_cache_flush(aux);
+
 	return drm_dp_dpcd_access(aux, DP_AUX_NATIVE_WRITE, offset, buffer,
 				  size);
 }
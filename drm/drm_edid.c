@@ -1307,6 +1307,25 @@ struct edid *drm_do_get_edid(struct drm_connector *connector,
 	if (block[0x7e] == 0)
 		return (struct edid *)block;
 
+	/*
+	 * If the base block (and with it the checksum, serial number and
+	 * extension count) is identical to the last complete read, the sink
+	 * has not changed and the extensions don't need to be fetched again.
+	 */
+	if (connector->edid_cache &&
+	    memcmp(connector->edid_cache, block, EDID_LENGTH) == 0) {
+		new = krealloc(block, (block[0x7e] + 1) * EDID_LENGTH,
+			       GFP_KERNEL);
+		if (!new)
+			goto out;
+		block = new;
+		memcpy(block + EDID_LENGTH,
+		       (u8 *)connector->edid_cache + EDID_LENGTH,
+		       block[0x7e] * EDID_LENGTH);
+		connector->edid_cache_hits++;
+		return (struct edid *)block;
+	}
+
 	new = krealloc(block, (block[0x7e] + 1) * EDID_LENGTH, GFP_KERNEL);
 	if (!new)
 		goto out;
@@ -1343,6 +1362,12 @@ struct edid *drm_do_get_edid(struct drm_connector *connector,
 		if (!new)
 			goto out;
 		block = new;
+	} else {
+		/* only remember reads where every extension was intact */
+		kfree(connector->edid_cache);
+		connector->edid_cache = kmemdup(block,
+						(valid_extensions + 1) * EDID_LENGTH,
+						GFP_KERNEL);
 	}
 
 	return (struct edid *)block;
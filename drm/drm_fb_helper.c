@@ -660,19 +660,20 @@ static void drm_fb_helper_dirty_work(struct work_struct *work)
 {
 	struct drm_fb_helper *helper = container_of(work, struct drm_fb_helper,
 						    dirty_work);
-	struct drm_clip_rect *clip = &helper->dirty_clip;
-	struct drm_clip_rect clip_copy;
+	struct drm_clip_rect clips[DRM_FB_HELPER_MAX_DIRTY_CLIPS];
+	unsigned int num_clips;
 	unsigned long flags;
 
 	spin_lock_irqsave(&helper->dirty_lock, flags);
-	clip_copy = *clip;
-	clip->x1 = clip->y1 = ~0;
-	clip->x2 = clip->y2 = 0;
+	num_clips = helper->num_dirty_clips;
+	memcpy(clips, helper->dirty_clips, num_clips * sizeof(clips[0]));
+	helper->num_dirty_clips = 0;
 	spin_unlock_irqrestore(&helper->dirty_lock, flags);
 
 	/* call dirty callback only when it has been really touched */
-	if (clip_copy.x1 < clip_copy.x2 && clip_copy.y1 < clip_copy.y2)
-		helper->fb->funcs->dirty(helper->fb, NULL, 0, 0, &clip_copy, 1);
+	if (num_clips)
+		helper->fb->funcs->dirty(helper->fb, NULL, 0, 0,
+					 clips, num_clips);
 }
 
 /**
@@ -691,7 +692,7 @@ void drm_fb_helper_prepare(struct drm_device *dev, struct drm_fb_helper *helper,
 	spin_lock_init(&helper->dirty_lock);
 	INIT_WORK(&helper->resume_work, drm_fb_helper_resume_worker);
 	INIT_WORK(&helper->dirty_work, drm_fb_helper_dirty_work);
-	helper->dirty_clip.x1 = helper->dirty_clip.y1 = ~0;
+	helper->num_dirty_clips = 0;
 	helper->funcs = funcs;
 	helper->dev = dev;
 }
@@ -874,21 +875,124 @@ void drm_fb_helper_unlink_fbi(struct drm_fb_helper *fb_helper)
 }
 EXPORT_SYMBOL(drm_fb_helper_unlink_fbi);
 
+static u64 drm_fb_helper_clip_area(const struct drm_clip_rect *clip)
+{
+	return (u64)(clip->x2 - clip->x1) * (clip->y2 - clip->y1);
+}
+
+static void drm_fb_helper_clip_union(struct drm_clip_rect *dst,
+				     const struct drm_clip_rect *clip)
+{
+	dst->x1 = min(dst->x1, clip->x1);
+	dst->y1 = min(dst->y1, clip->y1);
+	dst->x2 = max(dst->x2, clip->x2);
+	dst->y2 = max(dst->y2, clip->y2);
+}
+
+/*
+ * Area flushed needlessly if @a and @b are replaced by their bounding box.
+ * Zero or negative when they overlap or touch enough for merging to be free.
+ */
+static s64 drm_fb_helper_clip_merge_cost(const struct drm_clip_rect *a,
+					 const struct drm_clip_rect *b)
+{
+	struct drm_clip_rect u = *a;
+
+	drm_fb_helper_clip_union(&u, b);
+
+	return (s64)drm_fb_helper_clip_area(&u) -
+	       (s64)drm_fb_helper_clip_area(a) -
+	       (s64)drm_fb_helper_clip_area(b);
+}
+
+static bool drm_fb_helper_clip_intersect(const struct drm_clip_rect *a,
+					 const struct drm_clip_rect *b)
+{
+	return a->x1 < b->x2 && b->x1 < a->x2 &&
+	       a->y1 < b->y2 && b->y1 < a->y2;
+}
+
+/*
+ * Add @clip to the set of disjoint damage rectangles.  It is merged with
+ * every rectangle it overlaps or can be merged with for free.  If no slot
+ * is left, the pair of rectangles whose bounding box wastes the least
+ * area is merged.  Called with dirty_lock held.
+ */
+static void drm_fb_helper_add_damage(struct drm_fb_helper *helper,
+				     struct drm_clip_rect clip)
+{
+	struct drm_clip_rect *clips = helper->dirty_clips;
+	struct drm_clip_rect merged;
+	unsigned int n = helper->num_dirty_clips;
+	unsigned int i, j, best_i, best_j;
+	s64 cost, best_cost;
+
+again:
+	for (i = 0; i < n; i++) {
+		if (drm_fb_helper_clip_intersect(&clips[i], &clip) ||
+		    drm_fb_helper_clip_merge_cost(&clips[i], &clip) <= 0) {
+			drm_fb_helper_clip_union(&clip, &clips[i]);
+			clips[i] = clips[--n];
+			goto again;
+		}
+	}
+
+	if (n < DRM_FB_HELPER_MAX_DIRTY_CLIPS) {
+		clips[n++] = clip;
+		helper->num_dirty_clips = n;
+		return;
+	}
+
+	/* all slots taken, j == n stands for @clip */
+	best_i = 0;
+	best_j = 1;
+	best_cost = drm_fb_helper_clip_merge_cost(&clips[0], &clips[1]);
+	for (i = 0; i < n; i++) {
+		for (j = i + 1; j <= n; j++) {
+			cost = drm_fb_helper_clip_merge_cost(&clips[i],
+					j == n ? &clip : &clips[j]);
+			if (cost < best_cost) {
+				best_cost = cost;
+				best_i = i;
+				best_j = j;
+			}
+		}
+	}
+
+	if (best_j == n) {
+		drm_fb_helper_clip_union(&clip, &clips[best_i]);
+		clips[best_i] = clips[--n];
+	} else {
+		/* @clip takes the slot of the merged pair, re-add the pair */
+		merged = clips[best_i];
+		drm_fb_helper_clip_union(&merged, &clips[best_j]);
+		clips[best_i] = clip;
+		clips[best_j] = clips[--n];
+		clip = merged;
+	}
+	goto again;
+}
+
 static void drm_fb_helper_dirty(struct fb_info *info, u32 x, u32 y,
 				u32 width, u32 height)
 {
 	struct drm_fb_helper *helper = info->par;
-	struct drm_clip_rect *clip = &helper->dirty_clip;
+	struct drm_clip_rect clip;
 	unsigned long flags;
 
 	if (!helper->fb->funcs->dirty)
 		return;
 
+	if (!width || !height)
+		return;
+
+	clip.x1 = x;
+	clip.y1 = y;
+	clip.x2 = x + width;
+	clip.y2 = y + height;
+
 	spin_lock_irqsave(&helper->dirty_lock, flags);
-	clip->x1 = min_t(u32, clip->x1, x);
-	clip->y1 = min_t(u32, clip->y1, y);
-	clip->x2 = max_t(u32, clip->x2, x + width);
-	clip->y2 = max_t(u32, clip->y2, y + height);
+	drm_fb_helper_add_damage(helper, clip);
 	spin_unlock_irqrestore(&helper->dirty_lock, flags);
 
 	schedule_work(&helper->dirty_work);
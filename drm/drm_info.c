@@ -127,6 +127,43 @@ int drm_clients_info(struct seq_file *m, void *data)
 	return 0;
 }
 
+/**
+ * Called when "/proc/dri/.../vblank_events" is read.
+ *
+ */
+int drm_vblank_events_info(struct seq_file *m, void *data)
+{
+	struct drm_info_node *node = (struct drm_info_node *) m->private;
+	struct drm_device *dev = node->minor->dev;
+	struct drm_pending_vblank_event *e;
+	unsigned int pipe, pending;
+
+	seq_printf(m, "%4s %8s %12s %12s %12s %12s\n",
+		   "pipe", "pending", "sent", "late", "avg_us", "max_us");
+
+	spin_lock_irq(&dev->event_lock);
+	for (pipe = 0; pipe < dev->num_crtcs; pipe++) {
+		struct drm_vblank_crtc *vblank = &dev->vblank[pipe];
+
+		pending = 0;
+		list_for_each_entry(e, &vblank->event_list, base.link)
+			pending++;
+
+		seq_printf(m, "%4u %8u %12llu %12llu %12llu %12llu\n",
+			   pipe, pending,
+			   (unsigned long long)vblank->events_sent,
+			   (unsigned long long)vblank->events_late,
+			   vblank->events_sent ?
+			   (unsigned long long)div64_u64(vblank->delivery_ns,
+				vblank->events_sent * NSEC_PER_USEC) : 0,
+			   (unsigned long long)div_u64(vblank->delivery_max_ns,
+						       NSEC_PER_USEC));
+	}
+	spin_unlock_irq(&dev->event_lock);
+
+	return 0;
+}
+
 static int drm_gem_one_name_info(int id, void *ptr, void *data)
 {
 	struct drm_gem_object *obj = ptr;
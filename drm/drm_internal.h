@@ -50,6 +50,7 @@ void drm_prime_remove_buf_handle_locked(struct drm_prime_file_private *prime_fpr
 int drm_name_info(struct seq_file *m, void *data);
 int drm_clients_info(struct seq_file *m, void* data);
 int drm_gem_name_info(struct seq_file *m, void *data);
+int drm_vblank_events_info(struct seq_file *m, void *data);
 
 /* drm_irq.c */
 int drm_control(struct drm_device *dev, void *data,
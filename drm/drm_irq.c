@@ -379,6 +379,7 @@ int drm_vblank_init(struct drm_device *dev, unsigned int num_crtcs)
 		vblank->dev = dev;
 		vblank->pipe = i;
 		init_waitqueue_head(&vblank->queue);
+		INIT_LIST_HEAD(&vblank->event_list);
 		setup_timer(&vblank->disable_timer, vblank_disable_fn,
 			    (unsigned long)vblank);
 		seqlock_init(&vblank->seqlock);
@@ -1003,6 +1004,51 @@ static void send_vblank_event(struct drm_device *dev,
 	drm_send_event_locked(dev, &e->base);
 }
 
+/*
+ * An event may be sent once the vblank count has reached its due sequence,
+ * allowing for up to 2^23 vblanks of lag, as drm_queue_vblank_event() always
+ * did.
+ */
+static bool drm_vblank_event_due(const struct drm_pending_vblank_event *e,
+				 unsigned int seq)
+{
+	return (seq - e->due_sequence) <= (1 << 23);
+}
+
+/* Number of vblanks until @e is due at vblank count @seq, 0 if it is. */
+static unsigned int
+drm_vblank_event_wait(const struct drm_pending_vblank_event *e,
+		      unsigned int seq)
+{
+	return drm_vblank_event_due(e, seq) ? 0 : e->due_sequence - seq;
+}
+
+/*
+ * Queue @e on its pipe, keeping the list sorted by how far away, as seen
+ * from the current vblank count @seq, each event is from being due. That is
+ * the order in which drm_handle_vblank_events() finds them due. New events
+ * almost always target the latest sequence, so search from the tail.
+ * Caller must hold event_lock.
+ */
+static void drm_vblank_event_enqueue(struct drm_device *dev,
+				     struct drm_pending_vblank_event *e,
+				     unsigned int seq)
+{
+	struct drm_vblank_crtc *vblank = &dev->vblank[e->pipe];
+	struct drm_pending_vblank_event *pos;
+	unsigned int wait = drm_vblank_event_wait(e, seq);
+
+	assert_spin_locked(&dev->event_lock);
+
+	list_for_each_entry_reverse(pos, &vblank->event_list, base.link) {
+		if (drm_vblank_event_wait(pos, seq) <= wait) {
+			list_add(&e->base.link, &pos->base.link);
+			return;
+		}
+	}
+	list_add(&e->base.link, &vblank->event_list);
+}
+
 /**
  * drm_crtc_arm_vblank_event - arm vblank event after pageflip
  * @crtc: the source CRTC of the vblank event
@@ -1052,7 +1098,8 @@ void drm_crtc_arm_vblank_event(struct drm_crtc *crtc,
 
 	e->pipe = pipe;
 	e->event.sequence = drm_vblank_count(dev, pipe);
-	list_add_tail(&e->base.link, &dev->vblank_event_list);
+	e->due_sequence = e->event.sequence + 1;
+	drm_vblank_event_enqueue(dev, e, e->event.sequence);
 }
 EXPORT_SYMBOL(drm_crtc_arm_vblank_event);
 
@@ -1325,9 +1372,7 @@ void drm_vblank_off(struct drm_device *dev, unsigned int pipe)
 	/* Send any queued vblank events, lest the natives grow disquiet */
 	seq = drm_vblank_count_and_time(dev, pipe, &now);
 
-	list_for_each_entry_safe(e, t, &dev->vblank_event_list, base.link) {
-		if (e->pipe != pipe)
-			continue;
+	list_for_each_entry_safe(e, t, &vblank->event_list, base.link) {
 		DRM_DEBUG("Sending premature vblank event on disable: "
 			  "wanted %u, current %u\n",
 			  e->event.sequence, seq);
@@ -1386,7 +1431,7 @@ void drm_crtc_vblank_reset(struct drm_crtc *crtc)
 	}
 	spin_unlock_irqrestore(&dev->vbl_lock, irqflags);
 
-	WARN_ON(!list_empty(&dev->vblank_event_list));
+	WARN_ON(!list_empty(&vblank->event_list));
 }
 EXPORT_SYMBOL(drm_crtc_vblank_reset);
 
@@ -1632,7 +1677,8 @@ static int drm_queue_vblank_event(struct drm_device *dev, unsigned int pipe,
 		vblwait->reply.sequence = seq;
 	} else {
 		/* drm_handle_vblank_events will call drm_vblank_put */
-		list_add_tail(&e->base.link, &dev->vblank_event_list);
+		e->due_sequence = e->event.sequence;
+		drm_vblank_event_enqueue(dev, e, seq);
 		vblwait->reply.sequence = vblwait->request.sequence;
 	}
 
@@ -1755,26 +1801,39 @@ done:
 
 static void drm_handle_vblank_events(struct drm_device *dev, unsigned int pipe)
 {
+	struct drm_vblank_crtc *vblank = &dev->vblank[pipe];
 	struct drm_pending_vblank_event *e, *t;
-	struct timeval now;
+	struct timeval now, sent;
 	unsigned int seq;
+	s64 latency;
 
 	assert_spin_locked(&dev->event_lock);
 
 	seq = drm_vblank_count_and_time(dev, pipe, &now);
 
-	list_for_each_entry_safe(e, t, &dev->vblank_event_list, base.link) {
-		if (e->pipe != pipe)
-			continue;
-		if ((seq - e->event.sequence) > (1<<23))
-			continue;
+	/* The list is sorted, so stop at the first event which isn't due. */
+	list_for_each_entry_safe(e, t, &vblank->event_list, base.link) {
+		if (!drm_vblank_event_due(e, seq))
+			break;
 
 		DRM_DEBUG("vblank event on %u, current %u\n",
 			  e->event.sequence, seq);
 
+		if (seq != e->due_sequence)
+			vblank->events_late++;
+
 		list_del(&e->base.link);
 		drm_vblank_put(dev, pipe);
 		send_vblank_event(dev, e, seq, &now);
+
+		sent = get_drm_timestamp();
+		latency = timeval_to_ns(&sent) - timeval_to_ns(&now);
+		if (latency > 0) {
+			vblank->delivery_ns += latency;
+			if (latency > vblank->delivery_max_ns)
+				vblank->delivery_max_ns = latency;
+		}
+		vblank->events_sent++;
 	}
 
 	trace_drm_vblank_event(pipe, seq);
@@ -182,6 +182,30 @@ void drm_mode_object_reference(struct drm_mode_object *obj)
 }
 EXPORT_SYMBOL(drm_mode_object_reference);
 
+static inline unsigned int drm_object_prop_hash(uint32_t prop_id)
+{
+	return prop_id & (DRM_OBJECT_PROP_HASH_SIZE - 1);
+}
+
+static int drm_object_prop_index(struct drm_object_properties *props,
+				 uint32_t prop_id)
+{
+	unsigned int h = drm_object_prop_hash(prop_id);
+	unsigned int n;
+
+	for (n = 0; n < DRM_OBJECT_PROP_HASH_SIZE; n++) {
+		uint8_t slot = props->index[h];
+
+		if (slot == 0)
+			break;
+		if (props->properties[slot - 1]->base.id == prop_id)
+			return slot - 1;
+		h = (h + 1) & (DRM_OBJECT_PROP_HASH_SIZE - 1);
+	}
+
+	return -1;
+}
+
 /**
  * drm_object_attach_property - attach a property to a modeset object
  * @obj: drm modeset object
@@ -197,6 +221,7 @@ void drm_object_attach_property(struct drm_mode_object *obj,
 				uint64_t init_val)
 {
 	int count = obj->properties->count;
+	unsigned int h;
 
 	if (count == DRM_OBJECT_MAX_PROPERTY) {
 		WARN(1, "Failed to attach object property (type: 0x%x). Please "
@@ -209,6 +234,11 @@ void drm_object_attach_property(struct drm_mode_object *obj,
 	obj->properties->properties[count] = property;
 	obj->properties->values[count] = init_val;
 	obj->properties->count++;
+
+	h = drm_object_prop_hash(property->base.id);
+	while (obj->properties->index[h] != 0)
+		h = (h + 1) & (DRM_OBJECT_PROP_HASH_SIZE - 1);
+	obj->properties->index[h] = count + 1;
 }
 EXPORT_SYMBOL(drm_object_attach_property);
 
@@ -377,11 +407,11 @@ struct drm_property *drm_mode_obj_find_prop_id(struct drm_mode_object *obj,
 {
 	int i;
 
-	for (i = 0; i < obj->properties->count; i++)
-		if (obj->properties->properties[i]->base.id == prop_id)
-			return obj->properties->properties[i];
+	i = drm_object_prop_index(obj->properties, prop_id);
+	if (i < 0)
+		return NULL;
 
-	return NULL;
+	return obj->properties->properties[i];
 }
 
 int drm_mode_obj_set_property_ioctl(struct drm_device *dev, void *data,
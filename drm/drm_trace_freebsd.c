@@ -0,0 +1,200 @@
+#include <sys/cdefs.h>
+__FBSDID("$FreeBSD$");
+
+/** @file drm_trace_freebsd.c
+ * Per-CPU binary event ring for the FreeBSD trace_*() stubs and its
+ * Chrome/Perfetto JSON reader, see drm_trace_freebsd.h.
+ */
+
+#include <drm/drmP.h>
+#include <drm/drm_trace_freebsd.h>
+
+#include <sys/sbuf.h>
+#include <sys/sysctl.h>
+
+MALLOC_DEFINE(DRM_MEM_TRACE, "drm_trace", "DRM trace event rings");
+
+#define	DRM_TRACE_RING_MASK	(DRM_TRACE_RING_SIZE - 1)
+
+CTASSERT((DRM_TRACE_RING_SIZE & DRM_TRACE_RING_MASK) == 0);
+
+struct drm_trace_ring {
+	/* index of the next record to write, never wraps */
+	volatile uint64_t	head;
+	struct drm_trace_rec	recs[DRM_TRACE_RING_SIZE];
+};
+
+int drm_trace_enabled;
+static struct drm_trace_ring *drm_trace_rings[MAXCPU];
+static struct sx drm_trace_lock;
+SX_SYSINIT(drm_trace_lock, &drm_trace_lock, "drm trace");
+
+void
+drm_trace_record(const char *name, char ph, int nargs,
+    uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3)
+{
+	struct drm_trace_ring *ring;
+	struct drm_trace_rec *rec;
+	uint64_t idx;
+
+	/*
+	 * Stay on this CPU while writing.  Interrupt filters may still
+	 * nest, the atomic increment gives them a record of their own.
+	 */
+	critical_enter();
+	ring = drm_trace_rings[curcpu];
+	if (ring == NULL) {
+		critical_exit();
+		return;
+	}
+
+	idx = atomic_fetchadd_64(&ring->head, 1);
+	rec = &ring->recs[idx & DRM_TRACE_RING_MASK];
+
+	/* let readers see the record is being rewritten before we touch it */
+	atomic_store_rel_64(&rec->seq, 0);
+	atomic_thread_fence_rel();
+
+	rec->ts = sbinuptime();
+	strlcpy(rec->name, name, sizeof(rec->name));
+	rec->args[0] = a0;
+	rec->args[1] = a1;
+	rec->args[2] = a2;
+	rec->args[3] = a3;
+	rec->tid = curthread->td_tid;
+	rec->nargs = nargs;
+	rec->ph = ph;
+
+	atomic_store_rel_64(&rec->seq, idx + 1);
+	critical_exit();
+}
+
+/*
+ * Copy record idx out of the ring.  Returns false if the record was
+ * still being written, or has already been overwritten by a newer one.
+ */
+static bool
+drm_trace_read_rec(struct drm_trace_ring *ring, uint64_t idx,
+    struct drm_trace_rec *out)
+{
+	struct drm_trace_rec *rec = &ring->recs[idx & DRM_TRACE_RING_MASK];
+
+	if (atomic_load_acq_64(&rec->seq) != idx + 1)
+		return (false);
+
+	*out = *rec;
+	atomic_thread_fence_acq();
+
+	return (atomic_load_acq_64(&rec->seq) == idx + 1);
+}
+
+static void
+drm_trace_print_rec(struct sbuf *sb, const struct drm_trace_rec *rec, int cpu)
+{
+	uint64_t ns = sbttons(rec->ts);
+	int i;
+
+	sbuf_printf(sb, "{\"name\":\"%.*s\",\"ph\":\"%c\",",
+	    DRM_TRACE_NAME_LEN, rec->name, rec->ph);
+	if (rec->ph == 'i')
+		sbuf_printf(sb, "\"s\":\"t\",");
+	sbuf_printf(sb, "\"ts\":%ju.%03ju,\"pid\":0,\"tid\":%d,",
+	    (uintmax_t)(ns / 1000), (uintmax_t)(ns % 1000), rec->tid);
+	sbuf_printf(sb, "\"args\":{\"cpu\":%d", cpu);
+	for (i = 0; i < rec->nargs && i < DRM_TRACE_MAX_ARGS; i++)
+		sbuf_printf(sb, ",\"a%d\":\"0x%jx\"", i,
+		    (uintmax_t)rec->args[i]);
+	sbuf_printf(sb, "}}");
+}
+
+static int
+drm_trace_json_sysctl(SYSCTL_HANDLER_ARGS)
+{
+	struct drm_trace_ring *ring;
+	struct drm_trace_rec rec;
+	struct sbuf sb;
+	uint64_t idx, head;
+	bool first = true;
+	int cpu, error;
+
+	sbuf_new_for_sysctl(&sb, NULL, PAGE_SIZE, req);
+	sbuf_printf(&sb, "{\"traceEvents\":[");
+
+	sx_slock(&drm_trace_lock);
+	CPU_FOREACH(cpu) {
+		ring = drm_trace_rings[cpu];
+		if (ring == NULL)
+			continue;
+
+		head = atomic_load_acq_64(&ring->head);
+		idx = head > DRM_TRACE_RING_SIZE ? head - DRM_TRACE_RING_SIZE : 0;
+		for (; idx < head; idx++) {
+			if (!drm_trace_read_rec(ring, idx, &rec))
+				continue;
+
+			if (!first)
+				sbuf_printf(&sb, ",\n");
+			first = false;
+			drm_trace_print_rec(&sb, &rec, cpu);
+		}
+	}
+	sx_sunlock(&drm_trace_lock);
+
+	sbuf_printf(&sb, "],\"displayTimeUnit\":\"ns\"}\n");
+	error = sbuf_finish(&sb);
+	sbuf_delete(&sb);
+
+	return (error);
+}
+
+static int
+drm_trace_enable_sysctl(SYSCTL_HANDLER_ARGS)
+{
+	struct drm_trace_ring *ring;
+	int cpu, enable, error;
+
+	enable = drm_trace_enabled;
+	error = sysctl_handle_int(oidp, &enable, 0, req);
+	if (error != 0 || req->newptr == NULL)
+		return (error);
+
+	sx_xlock(&drm_trace_lock);
+	if (enable) {
+		CPU_FOREACH(cpu) {
+			if (drm_trace_rings[cpu] != NULL)
+				continue;
+			ring = malloc(sizeof(*ring), DRM_MEM_TRACE,
+			    M_WAITOK | M_ZERO);
+			atomic_store_rel_ptr(
+			    (volatile uintptr_t *)&drm_trace_rings[cpu],
+			    (uintptr_t)ring);
+		}
+	}
+	drm_trace_enabled = enable != 0;
+	sx_xunlock(&drm_trace_lock);
+
+	return (0);
+}
+
+SYSCTL_DECL(_dev_drm);
+static SYSCTL_NODE(_dev_drm, OID_AUTO, trace, CTLFLAG_RW, 0,
+    "DRM event tracing");
+SYSCTL_PROC(_dev_drm_trace, OID_AUTO, enable,
+    CTLTYPE_INT | CTLFLAG_RW | CTLFLAG_MPSAFE, NULL, 0,
+    drm_trace_enable_sysctl, "I", "record trace events");
+SYSCTL_PROC(_dev_drm_trace, OID_AUTO, json,
+    CTLTYPE_STRING | CTLFLAG_RD | CTLFLAG_MPSAFE, NULL, 0,
+    drm_trace_json_sysctl, "A", "recorded trace events as Chrome/Perfetto JSON");
+
+static void
+drm_trace_fini(void *arg __unused)
+{
+	int cpu;
+
+	drm_trace_enabled = 0;
+	CPU_FOREACH(cpu) {
+		free(drm_trace_rings[cpu], DRM_MEM_TRACE);
+		drm_trace_rings[cpu] = NULL;
+	}
+}
+SYSUNINIT(drm_trace_fini, SI_SUB_KLD, SI_ORDER_ANY, drm_trace_fini, NULL);
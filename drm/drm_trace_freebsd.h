@@ -0,0 +1,64 @@
+/**
+ * \file drm_trace_freebsd.h
+ * Per-CPU binary event ring backing the FreeBSD trace_*() stubs.
+ *
+ * Every CPU owns a ring of DRM_TRACE_RING_SIZE fixed-size records which
+ * are written without locks; the oldest records are overwritten once a
+ * ring wraps.  Tracing is off by default, set dev.drm.trace.enable=1 to
+ * start recording and read dev.drm.trace.json to get the events in the
+ * Chrome/Perfetto trace event format.
+ */
+
+#ifndef _DRM_TRACE_FREEBSD_H_
+#define	_DRM_TRACE_FREEBSD_H_
+
+#include <sys/types.h>
+#include <sys/time.h>
+
+#define	DRM_TRACE_RING_SIZE	4096
+#define	DRM_TRACE_NAME_LEN	32
+#define	DRM_TRACE_MAX_ARGS	4
+
+struct drm_trace_rec {
+	/* ring index + 1 once the record is complete, 0 while written */
+	uint64_t	seq;
+	sbintime_t	ts;
+	char		name[DRM_TRACE_NAME_LEN];
+	uint64_t	args[DRM_TRACE_MAX_ARGS];
+	lwpid_t		tid;
+	uint8_t		nargs;
+	char		ph;
+};
+
+extern int drm_trace_enabled;
+
+void drm_trace_record(const char *name, char ph, int nargs,
+    uint64_t a0, uint64_t a1, uint64_t a2, uint64_t a3);
+
+#define	DRM_TRACE_EVENT(ph, name, n, a0, a1, a2, a3)			\
+	do {								\
+		if (__predict_false(drm_trace_enabled))			\
+			drm_trace_record((name), (ph), (n),		\
+			    (uint64_t)(a0), (uint64_t)(a1),		\
+			    (uint64_t)(a2), (uint64_t)(a3));		\
+	} while (0)
+
+/* instant events, pointers should be passed as uintptr_t */
+#define	DRM_TRACE0(name)						\
+	DRM_TRACE_EVENT('i', name, 0, 0, 0, 0, 0)
+#define	DRM_TRACE1(name, a0)						\
+	DRM_TRACE_EVENT('i', name, 1, a0, 0, 0, 0)
+#define	DRM_TRACE2(name, a0, a1)					\
+	DRM_TRACE_EVENT('i', name, 2, a0, a1, 0, 0)
+#define	DRM_TRACE3(name, a0, a1, a2)					\
+	DRM_TRACE_EVENT('i', name, 3, a0, a1, a2, 0)
+#define	DRM_TRACE4(name, a0, a1, a2, a3)				\
+	DRM_TRACE_EVENT('i', name, 4, a0, a1, a2, a3)
+
+/* duration events, begin and end must be recorded by the same thread */
+#define	DRM_TRACE_BEGIN1(name, a0)					\
+	DRM_TRACE_EVENT('B', name, 1, a0, 0, 0, 0)
+#define	DRM_TRACE_END1(name, a0)					\
+	DRM_TRACE_EVENT('E', name, 1, a0, 0, 0, 0)
+
+#endif /* _DRM_TRACE_FREEBSD_H_ */
@@ -720,23 +720,242 @@ cfb_imageblit(struct linux_fb_info *p, const struct fb_image *image)
 	tainted_cfb_imageblit(p, image);
 }
 
+/*
+ * System memory framebuffers do not need the bit-addressed, I/O accessor
+ * based cfb code.  For the packed 8, 16 and 32bpp formats used by shadow
+ * buffers the sys_*() ops below work on whole pixels with plain memory
+ * accesses and fall back to the cfb code for everything else.
+ */
+static bool
+sys_fb_fast_bpp(struct linux_fb_info *p)
+{
+	u32 bpp = p->var.bits_per_pixel;
+
+	return (bpp == 8 || bpp == 16 || bpp == 32);
+}
+
+static u32
+sys_fb_color(struct linux_fb_info *p, u32 color)
+{
+
+	if (p->fix.visual == FB_VISUAL_TRUECOLOR ||
+	    p->fix.visual == FB_VISUAL_DIRECTCOLOR)
+		return (((u32 *)p->pseudo_palette)[color]);
+	return (color);
+}
+
+static __always_inline void
+sys_fb_fill_row(u8 *dst, u32 color, u32 width, const int cpp)
+{
+	u32 i;
+
+	switch (cpp) {
+	case 1:
+		memset(dst, color, width);
+		break;
+	case 2:
+		for (i = 0; i < width; i++, dst += 2)
+			*(u16 *)dst = color;
+		break;
+	default:
+		for (i = 0; i < width; i++, dst += 4)
+			*(u32 *)dst = color;
+		break;
+	}
+}
+
 void
 sys_fillrect(struct linux_fb_info *p, const struct fb_fillrect *rect)
 {
-	tainted_cfb_fillrect(p, rect);
+	u32 cpp, color, pitch, height, row;
+	u8 *dst;
+
+	if (p->state != FBINFO_STATE_RUNNING)
+		return;
+
+	if (rect->rop != ROP_COPY || !sys_fb_fast_bpp(p)) {
+		tainted_cfb_fillrect(p, rect);
+		return;
+	}
+
+	if (rect->width == 0 || rect->height == 0)
+		return;
+
+	if (p->fbops->fb_sync)
+		p->fbops->fb_sync(p);
+
+	cpp = p->var.bits_per_pixel / 8;
+	pitch = p->fix.line_length;
+	color = sys_fb_color(p, rect->color);
+	dst = (u8 *)p->screen_base + rect->dy * pitch + rect->dx * cpp;
+	height = rect->height;
+	row = rect->width * cpp;
+
+	/* expand the first row, then replicate it */
+	switch (cpp) {
+	case 1:
+		sys_fb_fill_row(dst, color, rect->width, 1);
+		break;
+	case 2:
+		sys_fb_fill_row(dst, color, rect->width, 2);
+		break;
+	default:
+		sys_fb_fill_row(dst, color, rect->width, 4);
+		break;
+	}
+	while (--height) {
+		memcpy(dst + pitch, dst, row);
+		dst += pitch;
+	}
 }
 
 void
 sys_copyarea(struct linux_fb_info *p, const struct fb_copyarea *area)
 {
+	u32 cpp, pitch, height, row;
+	u8 *dst, *src;
 
-	tainted_cfb_copyarea(p, area);
+	if (p->state != FBINFO_STATE_RUNNING)
+		return;
+
+	if (!sys_fb_fast_bpp(p)) {
+		tainted_cfb_copyarea(p, area);
+		return;
+	}
+
+	if (p->fbops->fb_sync)
+		p->fbops->fb_sync(p);
+
+	cpp = p->var.bits_per_pixel / 8;
+	pitch = p->fix.line_length;
+	height = area->height;
+	row = area->width * cpp;
+	dst = (u8 *)p->screen_base + area->dy * pitch + area->dx * cpp;
+	src = (u8 *)p->screen_base + area->sy * pitch + area->sx * cpp;
+
+	/*
+	 * memmove() takes care of overlap within a row, copy the rows
+	 * bottom up when scrolling down.
+	 */
+	if (area->dy > area->sy) {
+		dst += (height - 1) * pitch;
+		src += (height - 1) * pitch;
+		while (height--) {
+			memmove(dst, src, row);
+			dst -= pitch;
+			src -= pitch;
+		}
+	} else {
+		while (height--) {
+			memmove(dst, src, row);
+			dst += pitch;
+			src += pitch;
+		}
+	}
+}
+
+/*
+ * Expand a 1bpp image four pixels at a time.  tab[n] holds the four
+ * pixels for the bit nibble n, most significant bit leftmost, so every
+ * nibble is a single 4, 8 or 16 byte store.
+ */
+static __always_inline void
+sys_fb_imageblit_rows(const struct fb_image *image, u8 *dst1, u32 pitch,
+    u32 (*tab)[4], u32 fgcolor, u32 bgcolor, const int cpp)
+{
+	u32 spitch = (image->width + 7) / 8;
+	u32 bytes = image->width / 8, tail = image->width % 8;
+	const u8 *src = (const u8 *)image->data, *s;
+	u32 i, j, color;
+	u8 *dst;
+
+	for (i = image->height; i--; ) {
+		dst = dst1;
+		s = src;
+
+		for (j = bytes; j--; s++) {
+			memcpy(dst, tab[*s >> 4], 4 * cpp);
+			memcpy(dst + 4 * cpp, tab[*s & 0xf], 4 * cpp);
+			dst += 8 * cpp;
+		}
+
+		for (j = 0; j < tail; j++, dst += cpp) {
+			color = (*s & (0x80 >> j)) ? fgcolor : bgcolor;
+			switch (cpp) {
+			case 1:
+				*dst = color;
+				break;
+			case 2:
+				*(u16 *)dst = color;
+				break;
+			default:
+				*(u32 *)dst = color;
+				break;
+			}
+		}
+
+		dst1 += pitch;
+		src += spitch;
+	}
 }
 
 void
 sys_imageblit(struct linux_fb_info *p, const struct fb_image *image)
 {
-	tainted_cfb_imageblit(p, image);
+	u32 tab[16][4];
+	u32 cpp, fgcolor, bgcolor, pitch, color;
+	u8 *dst1;
+	int n, i;
+
+	if (p->state != FBINFO_STATE_RUNNING)
+		return;
+
+	if (image->depth != 1 || !sys_fb_fast_bpp(p)) {
+		tainted_cfb_imageblit(p, image);
+		return;
+	}
+
+	if (p->fbops->fb_sync)
+		p->fbops->fb_sync(p);
+
+	cpp = p->var.bits_per_pixel / 8;
+	pitch = p->fix.line_length;
+	fgcolor = sys_fb_color(p, image->fg_color);
+	bgcolor = sys_fb_color(p, image->bg_color);
+	dst1 = (u8 *)p->screen_base + image->dy * pitch + image->dx * cpp;
+
+	/* colour expansion table for this fg/bg pair */
+	for (n = 0; n < 16; n++) {
+		for (i = 0; i < 4; i++) {
+			color = (n & (8 >> i)) ? fgcolor : bgcolor;
+			switch (cpp) {
+			case 1:
+				((u8 *)tab[n])[i] = color;
+				break;
+			case 2:
+				((u16 *)tab[n])[i] = color;
+				break;
+			default:
+				tab[n][i] = color;
+				break;
+			}
+		}
+	}
+
+	switch (cpp) {
+	case 1:
+		sys_fb_imageblit_rows(image, dst1, pitch, tab, fgcolor,
+		    bgcolor, 1);
+		break;
+	case 2:
+		sys_fb_imageblit_rows(image, dst1, pitch, tab, fgcolor,
+		    bgcolor, 2);
+		break;
+	default:
+		sys_fb_imageblit_rows(image, dst1, pitch, tab, fgcolor,
+		    bgcolor, 4);
+		break;
+	}
 }
 
 static int
@@ -458,6 +458,12 @@ static int i915_gem_object_info(struct seq_file *m, void *data)
 	seq_printf(m, "%llu [%llu] gtt total\n",
 		   ggtt->base.total, ggtt->mappable_end - ggtt->base.start);
 
+	if (dev_priv->mm.shmem_populate_bytes >> 20)
+		seq_printf(m, "%llu MiB populated from shmem, %llu ns/MiB\n",
+			   dev_priv->mm.shmem_populate_bytes >> 20,
+			   div64_u64(dev_priv->mm.shmem_populate_ns,
+				     dev_priv->mm.shmem_populate_bytes >> 20));
+
 	seq_putc(m, '\n');
 	print_batch_pool_stats(m, dev_priv);
 	mutex_unlock(&dev->struct_mutex);
@@ -2481,6 +2487,7 @@ static void i915_guc_client_info(struct seq_file *m,
 		client->wq_size, client->wq_offset, client->wq_tail);
 
 	seq_printf(m, "\tWork queue full: %u\n", client->no_wq_space);
+	seq_printf(m, "\tDoorbells rung: %llu\n", client->doorbells);
 	seq_printf(m, "\tFailed doorbell: %u\n", client->b_fail);
 	seq_printf(m, "\tLast submission result: %d\n", client->retcode);
 
@@ -2522,6 +2529,9 @@ static int i915_guc_info(struct seq_file *m, void *data)
 
 	seq_printf(m, "GuC total action count: %llu\n", guc.action_count);
 	seq_printf(m, "GuC action failure count: %u\n", guc.action_fail);
+	seq_printf(m, "GuC coalesced action count: %llu\n", guc.action_coalesced);
+	seq_printf(m, "GuC average action latency: %llu us\n",
+		   guc.action_count ? guc.action_time_us / guc.action_count : 0);
 	seq_printf(m, "GuC last action command: 0x%x\n", guc.action_cmd);
 	seq_printf(m, "GuC last action status: 0x%x\n", guc.action_status);
 	seq_printf(m, "GuC last action error code: %d\n", guc.action_err);
@@ -2885,6 +2895,9 @@ static void intel_dp_info(struct seq_file *m,
 
 	seq_printf(m, "\tDPCD rev: %x\n", intel_dp->dpcd[DP_DPCD_REV]);
 	seq_printf(m, "\taudio support: %s\n", yesno(intel_dp->has_audio));
+	seq_printf(m, "\tDPCD cache: %u hits, %u misses\n",
+		   intel_dp->aux.dpcd_cache_hits,
+		   intel_dp->aux.dpcd_cache_misses);
 	if (intel_encoder->type == INTEL_OUTPUT_EDP)
 		intel_panel_info(m, &intel_connector->panel);
 
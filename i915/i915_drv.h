@@ -1375,6 +1375,10 @@ struct i915_gem_mm {
 	spinlock_t object_stat_lock;
 	size_t object_memory;
 	u32 object_count;
+
+	/** Time spent populating shmem backed objects, under struct_mutex */
+	u64 shmem_populate_ns;
+	u64 shmem_populate_bytes;
 };
 
 struct drm_i915_error_state_buf {
@@ -2269,6 +2273,12 @@ struct drm_i915_gem_object {
 	struct get_page {
 		struct scatterlist *sg;
 		int last;
+		/* Lazily built on the first backwards seek, sorted by page */
+		struct get_page_index {
+			struct scatterlist *sg;
+			int first;
+		} *index;
+		unsigned int nindex;
 	} get_page;
 	void *mapping;
 
@@ -3137,19 +3147,22 @@ static inline int __sg_page_count(struct scatterlist *sg)
 struct page *
 i915_gem_object_get_dirty_page(struct drm_i915_gem_object *obj, int n);
 
+void i915_gem_object_seek_page(struct drm_i915_gem_object *obj, int n);
+void i915_gem_object_reset_page_iter(struct drm_i915_gem_object *obj);
+
+/* Position obj->get_page on the sg entry containing page n */
+static inline void
+__i915_gem_object_seek_page(struct drm_i915_gem_object *obj, int n)
+{
+	if (n < obj->get_page.last ||
+	    n >= obj->get_page.last + __sg_page_count(obj->get_page.sg))
+		i915_gem_object_seek_page(obj, n);
+}
+
 static inline dma_addr_t
 i915_gem_object_get_dma_address(struct drm_i915_gem_object *obj, int n)
 {
-	if (n < obj->get_page.last) {
-		obj->get_page.sg = obj->pages->sgl;
-		obj->get_page.last = 0;
-	}
-
-	while (obj->get_page.last + __sg_page_count(obj->get_page.sg) <= n) {
-		obj->get_page.last += __sg_page_count(obj->get_page.sg++);
-		if (unlikely(sg_is_chain(obj->get_page.sg)))
-			obj->get_page.sg = sg_chain_ptr(obj->get_page.sg);
-	}
+	__i915_gem_object_seek_page(obj, n);
 
 	return sg_dma_address(obj->get_page.sg) + ((n - obj->get_page.last) << PAGE_SHIFT);
 }
@@ -3160,16 +3173,7 @@ i915_gem_object_get_page(struct drm_i915_gem_object *obj, int n)
 	if (WARN_ON(n >= obj->base.size >> PAGE_SHIFT))
 		return NULL;
 
-	if (n < obj->get_page.last) {
-		obj->get_page.sg = obj->pages->sgl;
-		obj->get_page.last = 0;
-	}
-
-	while (obj->get_page.last + __sg_page_count(obj->get_page.sg) <= n) {
-		obj->get_page.last += __sg_page_count(obj->get_page.sg++);
-		if (unlikely(sg_is_chain(obj->get_page.sg)))
-			obj->get_page.sg = sg_chain_ptr(obj->get_page.sg);
-	}
+	__i915_gem_object_seek_page(obj, n);
 
 	return nth_page(sg_page(obj->get_page.sg), n - obj->get_page.last);
 }
@@ -2295,27 +2295,81 @@ i915_gem_object_put_pages(struct drm_i915_gem_object *obj)
 
 	ops->put_pages(obj);
 	obj->pages = NULL;
+	i915_gem_object_reset_page_iter(obj);
 
 	i915_gem_object_invalidate(obj);
 
 	return 0;
 }
 
+/* Number of shmem pages acquired per call when populating an object */
+#define I915_SHMEM_BATCH 64
+
+#ifdef __FreeBSD__
+typedef vm_object_t i915_shmem_mapping_t;
+#else
+typedef struct address_space *i915_shmem_mapping_t;
+#endif
+
+/* Returns the number of consecutive pages read, stopping at the first
+ * failure.  The caller falls back to i915_gem_shmem_read_page_slow() to
+ * reclaim memory and retry if no page could be obtained at all.
+ */
 static int
-i915_gem_object_get_pages_gtt(struct drm_i915_gem_object *obj)
+i915_gem_shmem_read_pages(i915_shmem_mapping_t mapping, int start, int count,
+			  gfp_t gfp, struct page **pages)
 {
-	struct drm_i915_private *dev_priv = to_i915(obj->base.dev);
-	int page_count, i;
 #ifdef __FreeBSD__
-	vm_object_t mapping;
+	return shmem_read_mapping_pages_gfp(mapping, start, count, gfp, pages);
 #else
-	struct address_space *mapping;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		pages[i] = shmem_read_mapping_page_gfp(mapping, start + i, gfp);
+		if (IS_ERR(pages[i]))
+			break;
+	}
+	return i;
 #endif
+}
+
+static struct page *
+i915_gem_shmem_read_page_slow(struct drm_i915_private *dev_priv,
+			      i915_shmem_mapping_t mapping, int n,
+			      int page_count, gfp_t gfp)
+{
+	struct page *page;
+
+	i915_gem_shrink(dev_priv,
+			page_count,
+			I915_SHRINK_BOUND |
+			I915_SHRINK_UNBOUND |
+			I915_SHRINK_PURGEABLE);
+	page = shmem_read_mapping_page_gfp(mapping, n, gfp);
+	if (IS_ERR(page)) {
+		/* We've tried hard to allocate the memory by reaping
+		 * our own buffer, now let the real VM do its job and
+		 * go down in flames if truly OOM.
+		 */
+		i915_gem_shrink_all(dev_priv);
+		page = shmem_read_mapping_page(mapping, n);
+	}
+	return page;
+}
+
+static int
+i915_gem_object_get_pages_gtt(struct drm_i915_gem_object *obj)
+{
+	struct drm_i915_private *dev_priv = to_i915(obj->base.dev);
+	struct page *pvec[I915_SHMEM_BATCH];
+	int page_count, i, j, n;
+	i915_shmem_mapping_t mapping;
 	struct sg_table *st;
 	struct scatterlist *sg;
 	struct sgt_iter sgt_iter;
 	struct page *page;
 	unsigned long last_pfn = 0;	/* suppress gcc warning */
+	ktime_t start;
 	int ret;
 	gfp_t gfp;
 
@@ -2351,48 +2405,47 @@ i915_gem_object_get_pages_gtt(struct drm_i915_gem_object *obj)
 	gfp |= __GFP_NORETRY | __GFP_NOWARN;
 	sg = st->sgl;
 	st->nents = 0;
-	for (i = 0; i < page_count; i++) {
-		page = shmem_read_mapping_page_gfp(mapping, i, gfp);
-		if (IS_ERR(page)) {
-			i915_gem_shrink(dev_priv,
-					page_count,
-					I915_SHRINK_BOUND |
-					I915_SHRINK_UNBOUND |
-					I915_SHRINK_PURGEABLE);
-			page = shmem_read_mapping_page_gfp(mapping, i, gfp);
-		}
-		if (IS_ERR(page)) {
-			/* We've tried hard to allocate the memory by reaping
-			 * our own buffer, now let the real VM do its job and
-			 * go down in flames if truly OOM.
-			 */
-			i915_gem_shrink_all(dev_priv);
-			page = shmem_read_mapping_page(mapping, i);
+	start = ktime_get();
+	for (i = 0; i < page_count; ) {
+		n = i915_gem_shmem_read_pages(mapping, i,
+					      min(page_count - i,
+						  I915_SHMEM_BATCH),
+					      gfp, pvec);
+		if (n <= 0) {
+			page = i915_gem_shmem_read_page_slow(dev_priv, mapping,
+							     i, page_count,
+							     gfp);
 			if (IS_ERR(page)) {
 				ret = PTR_ERR(page);
 				goto err_sg;
 			}
+			pvec[0] = page;
+			n = 1;
 		}
+
+		for (j = 0; j < n; i++, j++) {
+			page = pvec[j];
 #ifdef CONFIG_SWIOTLB
-		if (swiotlb_nr_tbl()) {
-			st->nents++;
-			sg_set_page(sg, page, PAGE_SIZE, 0);
-			sg = sg_next(sg);
-			continue;
-		}
-#endif
-		if (!i || page_to_pfn(page) != last_pfn + 1) {
-			if (i)
+			if (swiotlb_nr_tbl()) {
+				st->nents++;
+				sg_set_page(sg, page, PAGE_SIZE, 0);
 				sg = sg_next(sg);
-			st->nents++;
-			sg_set_page(sg, page, PAGE_SIZE, 0);
-		} else {
-			sg->length += PAGE_SIZE;
-		}
-		last_pfn = page_to_pfn(page);
+				continue;
+			}
+#endif
+			if (!i || page_to_pfn(page) != last_pfn + 1) {
+				if (i)
+					sg = sg_next(sg);
+				st->nents++;
+				sg_set_page(sg, page, PAGE_SIZE, 0);
+			} else {
+				sg->length += PAGE_SIZE;
+			}
+			last_pfn = page_to_pfn(page);
 
-		/* Check that the i965g/gm workaround works. */
-		WARN_ON((gfp & __GFP_DMA32) && (last_pfn >= 0x00100000UL));
+			/* Check that the i965g/gm workaround works. */
+			WARN_ON((gfp & __GFP_DMA32) && (last_pfn >= 0x00100000UL));
+		}
 	}
 #ifdef CONFIG_SWIOTLB
 	if (!swiotlb_nr_tbl())
@@ -2400,6 +2453,10 @@ i915_gem_object_get_pages_gtt(struct drm_i915_gem_object *obj)
 		sg_mark_end(sg);
 	obj->pages = st;
 
+	dev_priv->mm.shmem_populate_ns +=
+		ktime_to_ns(ktime_sub(ktime_get(), start));
+	dev_priv->mm.shmem_populate_bytes += obj->base.size;
+
 	ret = i915_gem_gtt_prepare_object(obj);
 	if (ret)
 		goto err_pages;
@@ -2465,12 +2522,99 @@ i915_gem_object_get_pages(struct drm_i915_gem_object *obj)
 
 	list_add_tail(&obj->global_list, &dev_priv->mm.unbound_list);
 
-	obj->get_page.sg = obj->pages->sgl;
-	obj->get_page.last = 0;
+	i915_gem_object_reset_page_iter(obj);
 
 	return 0;
 }
 
+/**
+ * i915_gem_object_reset_page_iter - rewind the get_page cursor
+ * @obj: object whose backing pages have changed
+ *
+ * Discards the page index and points the cursor at the start of the
+ * current backing storage (if any).
+ */
+void i915_gem_object_reset_page_iter(struct drm_i915_gem_object *obj)
+{
+	kfree(obj->get_page.index);
+	obj->get_page.index = NULL;
+	obj->get_page.nindex = 0;
+	obj->get_page.sg = obj->pages ? obj->pages->sgl : NULL;
+	obj->get_page.last = 0;
+}
+
+static void i915_gem_object_build_page_index(struct drm_i915_gem_object *obj)
+{
+	struct get_page_index *index;
+	struct scatterlist *sg;
+	unsigned int nents = obj->pages->nents;
+	int i, first = 0;
+
+	/* We may be called from atomic context (error capture), so don't
+	 * sleep; if the allocation fails we just keep walking the list.
+	 */
+	index = kmalloc_array(nents, sizeof(*index),
+			      GFP_NOWAIT | __GFP_NOWARN);
+	if (!index)
+		return;
+
+	for_each_sg(obj->pages->sgl, sg, nents, i) {
+		index[i].sg = sg;
+		index[i].first = first;
+		first += __sg_page_count(sg);
+	}
+
+	obj->get_page.index = index;
+	obj->get_page.nindex = nents;
+}
+
+/**
+ * i915_gem_object_seek_page - move the get_page cursor to page n
+ * @obj: object with pages
+ * @n: page index within the object
+ *
+ * Sequential access simply advances the cursor along the scatterlist. The
+ * first time the caller goes backwards we build a sorted index of the sg
+ * entries, after which any miss is resolved with a binary search so that
+ * random access (relocations, pread/pwrite, error capture) costs
+ * O(log nents) rather than a walk from the start of the list.
+ */
+void i915_gem_object_seek_page(struct drm_i915_gem_object *obj, int n)
+{
+	struct get_page *iter = &obj->get_page;
+
+	if (n < iter->last && !iter->index)
+		i915_gem_object_build_page_index(obj);
+
+	if (iter->index) {
+		unsigned int lo = 0, hi = iter->nindex;
+
+		while (hi - lo > 1) {
+			unsigned int mid = lo + (hi - lo) / 2;
+
+			if (iter->index[mid].first <= n)
+				lo = mid;
+			else
+				hi = mid;
+		}
+
+		iter->sg = iter->index[lo].sg;
+		iter->last = iter->index[lo].first;
+		return;
+	}
+
+	if (n < iter->last) {
+		iter->sg = obj->pages->sgl;
+		iter->last = 0;
+	}
+
+	while (iter->last + __sg_page_count(iter->sg) <= n) {
+		iter->last += __sg_page_count(iter->sg++);
+		if (unlikely(sg_is_chain(iter->sg)))
+			iter->sg = sg_chain_ptr(iter->sg);
+	}
+}
+
 /* The 'mapping' part of i915_gem_object_pin_map() below */
 static void *i915_gem_object_map(const struct drm_i915_gem_object *obj,
 				 enum i915_map_type type)
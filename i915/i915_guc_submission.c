@@ -75,16 +75,14 @@ static inline bool host2guc_action_response(struct drm_i915_private *dev_priv,
 	return GUC2HOST_IS_RESPONSE(val);
 }
 
-static int host2guc_action(struct intel_guc *guc, u32 *data, u32 len)
+static int host2guc_action_mmio(struct intel_guc *guc, const u32 *data,
+				u32 len)
 {
 	struct drm_i915_private *dev_priv = guc_to_i915(guc);
 	u32 status;
 	int i;
 	int ret;
 
-	if (WARN_ON(len < 1 || len > 15))
-		return -EINVAL;
-
 	intel_uncore_forcewake_get(dev_priv, FORCEWAKE_ALL);
 
 	dev_priv->guc.action_count += 1;
@@ -127,6 +125,136 @@ static int host2guc_action(struct intel_guc *guc, u32 *data, u32 len)
 	return ret;
 }
 
+/*
+ * Host2GuC actions are queued and sent from a worker, one at a time and
+ * in order, so that the submitter only sleeps while the worker polls
+ * for the response, and callers that don't need the result don't wait
+ * at all. An action identical to the last one still queued is merged
+ * into it rather than sent twice. Each queued action holds a runtime pm
+ * reference until it has been sent, as its submitter may not wait for it.
+ */
+struct host2guc_request {
+	struct list_head link;
+	struct kref ref;
+	struct completion done;
+	ktime_t queued;
+	u32 data[15];
+	u32 len;
+	int ret;
+};
+
+static void host2guc_request_free(struct kref *ref)
+{
+	kfree(container_of(ref, struct host2guc_request, ref));
+}
+
+static void host2guc_action_work(struct work_struct *work)
+{
+	struct intel_guc *guc = container_of(work, struct intel_guc,
+					     action_work);
+	struct host2guc_request *rq;
+
+	for (;;) {
+		spin_lock(&guc->action_lock);
+		rq = list_first_entry_or_null(&guc->action_list,
+					      struct host2guc_request, link);
+		if (rq)
+			list_del_init(&rq->link);
+		spin_unlock(&guc->action_lock);
+		if (!rq)
+			break;
+
+		rq->ret = host2guc_action_mmio(guc, rq->data, rq->len);
+		guc->action_time_us += ktime_us_delta(ktime_get(), rq->queued);
+		intel_runtime_pm_put(guc_to_i915(guc));
+
+		complete_all(&rq->done);
+		kref_put(&rq->ref, host2guc_request_free);
+	}
+}
+
+static struct host2guc_request *
+host2guc_action_queue(struct intel_guc *guc, const u32 *data, u32 len)
+{
+	struct host2guc_request *rq, *last;
+
+	if (WARN_ON(len < 1 || len > 15))
+		return ERR_PTR(-EINVAL);
+
+	rq = kmalloc(sizeof(*rq), GFP_KERNEL);
+	if (!rq)
+		return ERR_PTR(-ENOMEM);
+
+	kref_init(&rq->ref);
+	init_completion(&rq->done);
+	memcpy(rq->data, data, len * sizeof(u32));
+	rq->len = len;
+	rq->queued = ktime_get();
+
+	spin_lock(&guc->action_lock);
+	last = list_empty(&guc->action_list) ? NULL :
+		list_last_entry(&guc->action_list,
+				struct host2guc_request, link);
+	if (last && last->len == len &&
+	    !memcmp(last->data, data, len * sizeof(u32))) {
+		/* The queued copy will do, share its result */
+		kref_get(&last->ref);
+		guc->action_coalesced += 1;
+		spin_unlock(&guc->action_lock);
+		kfree(rq);
+		return last;
+	}
+
+	/* Keep the device awake until the worker has sent it */
+	intel_runtime_pm_get_noresume(guc_to_i915(guc));
+
+	/* One reference for the list, one for the caller */
+	kref_get(&rq->ref);
+	list_add_tail(&rq->link, &guc->action_list);
+	spin_unlock(&guc->action_lock);
+
+	queue_work(system_wq, &guc->action_work);
+	return rq;
+}
+
+static int host2guc_action(struct intel_guc *guc, u32 *data, u32 len)
+{
+	struct host2guc_request *rq;
+	int ret;
+
+	rq = host2guc_action_queue(guc, data, len);
+	if (IS_ERR(rq))
+		return PTR_ERR(rq);
+
+	wait_for_completion(&rq->done);
+	ret = rq->ret;
+	kref_put(&rq->ref, host2guc_request_free);
+
+	return ret;
+}
+
+/* Send an action without waiting for (or caring about) the result */
+static void host2guc_action_async(struct intel_guc *guc, u32 *data, u32 len)
+{
+	struct host2guc_request *rq;
+
+	rq = host2guc_action_queue(guc, data, len);
+	if (!IS_ERR(rq))
+		kref_put(&rq->ref, host2guc_request_free);
+}
+
+void i915_guc_action_init(struct intel_guc *guc)
+{
+	spin_lock_init(&guc->action_lock);
+	INIT_LIST_HEAD(&guc->action_list);
+	INIT_WORK(&guc->action_work, host2guc_action_work);
+}
+
+void i915_guc_action_fini(struct intel_guc *guc)
+{
+	flush_work(&guc->action_work);
+}
+
 /*
  * Tell the GuC to allocate or deallocate a specific doorbell
  */
@@ -153,8 +281,8 @@ static int host2guc_release_doorbell(struct intel_guc *guc,
 	return host2guc_action(guc, data, 2);
 }
 
-static int host2guc_sample_forcewake(struct intel_guc *guc,
-				     struct i915_guc_client *client)
+static void host2guc_sample_forcewake(struct intel_guc *guc,
+				      struct i915_guc_client *client)
 {
 	struct drm_i915_private *dev_priv = guc_to_i915(guc);
 	u32 data[2];
@@ -167,7 +295,7 @@ static int host2guc_sample_forcewake(struct intel_guc *guc,
 		/* bit 0 and 1 are for Render and Media domain separately */
 		data[1] = GUC_FORCEWAKE_RENDER | GUC_FORCEWAKE_MEDIA;
 
-	return host2guc_action(guc, data, ARRAY_SIZE(data));
+	host2guc_action_async(guc, data, ARRAY_SIZE(data));
 }
 
 /*
@@ -586,6 +714,43 @@ static int guc_ring_doorbell(struct i915_guc_client *gc)
 	return ret;
 }
 
+/*
+ * Work items are appended to the work queue as requests are submitted,
+ * but the doorbell is rung at most once per batch: either as soon as
+ * GUC_WQ_BATCH_MAX items are pending, or from a tasklet scheduled by
+ * the first item of a batch. A burst of submissions (e.g. a fence
+ * signalling several waiting requests) thus only costs one cookie
+ * update and doorbell write, and no item waits for longer than it
+ * takes the tasklet to run.
+ */
+#define GUC_WQ_BATCH_MAX	16
+
+static void guc_flush_doorbell(struct i915_guc_client *client)
+{
+	int b_ret;
+
+	lockdep_assert_held(&client->wq_lock);
+
+	if (!client->wq_pending)
+		return;
+
+	b_ret = guc_ring_doorbell(client);
+	client->wq_pending = 0;
+	client->doorbells += 1;
+	client->retcode = b_ret;
+	if (b_ret)
+		client->b_fail += 1;
+}
+
+static void guc_doorbell_tasklet(unsigned long data)
+{
+	struct i915_guc_client *client = (struct i915_guc_client *)data;
+
+	spin_lock(&client->wq_lock);
+	guc_flush_doorbell(client);
+	spin_unlock(&client->wq_lock);
+}
+
 /**
  * i915_guc_submit() - Submit commands through GuC
  * @rq:		request associated with the commands
@@ -603,23 +768,25 @@ static int guc_ring_doorbell(struct i915_guc_client *gc)
  *
  * The only error here arises if the doorbell hardware isn't functioning
  * as expected, which really shouln't happen.
+ *
+ * The doorbell may be rung after this returns, see GUC_WQ_BATCH_MAX.
  */
 static void i915_guc_submit(struct drm_i915_gem_request *rq)
 {
 	unsigned int engine_id = rq->engine->id;
 	struct intel_guc *guc = &rq->i915->guc;
 	struct i915_guc_client *client = guc->execbuf_client;
-	int b_ret;
 
 	spin_lock(&client->wq_lock);
 	guc_wq_item_append(client, rq);
-	b_ret = guc_ring_doorbell(client);
 
-	client->submissions[engine_id] += 1;
-	client->retcode = b_ret;
-	if (b_ret)
-		client->b_fail += 1;
+	/* see GUC_WQ_BATCH_MAX above */
+	if (++client->wq_pending >= GUC_WQ_BATCH_MAX)
+		guc_flush_doorbell(client);
+	else if (client->wq_pending == 1)
+		tasklet_hi_schedule(&client->db_tasklet);
 
+	client->submissions[engine_id] += 1;
 	guc->submissions[engine_id] += 1;
 	guc->last_seqno[engine_id] = rq->fence.seqno;
 	spin_unlock(&client->wq_lock);
@@ -691,6 +858,9 @@ guc_client_free(struct drm_i915_private *dev_priv,
 	 */
 
 	if (client->client_base) {
+		/* Don't let a batched doorbell ring after this */
+		tasklet_kill(&client->db_tasklet);
+
 		/*
 		 * If we got as far as setting up a doorbell, make sure we
 		 * shut it down before unmapping & deallocating the memory.
@@ -815,6 +985,8 @@ guc_client_alloc(struct drm_i915_private *dev_priv,
 	client->client_base = kmap(i915_vma_first_page(vma));
 
 	spin_lock_init(&client->wq_lock);
+	tasklet_init(&client->db_tasklet, guc_doorbell_tasklet,
+		     (unsigned long)client);
 	client->wq_offset = GUC_DB_SIZE;
 	client->wq_size = GUC_WQ_SIZE;
 
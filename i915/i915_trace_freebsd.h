@@ -5,276 +5,241 @@
 #include "i915_drv.h"
 #include "intel_drv.h"
 #include "intel_ringbuffer.h"
+#include <drm/drm_trace_freebsd.h>
 
 static inline void
 trace_i915_flip_complete(enum plane plane, struct drm_i915_gem_object *pending_flip_obj)
 {
-	CTR2(KTR_DRM, "i915_flip_complete %d %p", plane, pending_flip_obj);
+	DRM_TRACE2("i915_flip_complete", plane, (uintptr_t)pending_flip_obj);
 }
 
 static inline void
 trace_i915_flip_request(enum plane plane, struct drm_i915_gem_object *obj)
 {
-	CTR2(KTR_DRM, "i915_flip_request %d %p", plane, obj);
+	DRM_TRACE2("i915_flip_request", plane, (uintptr_t)obj);
 }
-#if 0
-static inline void
-trace_i915_ring_wait_begin(struct intel_ring_buffer *ring){
-	CTR1(KTR_DRM, "ring_wait_begin %s", ring->name);
-}
-
-static inline void
-trace_i915_ring_wait_end(struct intel_ring_buffer *ring)
-{
-	CTR1(KTR_DRM, "ring_wait_end %s", ring->name);
-}
-
-static inline void
-trace_i915_gem_request_complete(struct intel_ring_buffer *ring, u32 seqno)
-{
-	CTR2(KTR_DRM, "request_complete %s %d", ring->name, seqno);
-}
-#endif
 
 static inline void
 trace_i915_gem_ring_flush(void *req, u32 arg1, u32 arg2)
 {
-	CTR3(KTR_DRM, "ring_flush %p %d %d", req, arg1, arg2);
+	DRM_TRACE3("i915_gem_ring_flush", (uintptr_t)req, arg1, arg2);
 }
 
 static inline void
-trace_i915_gem_ring_dispatch(void *req, u32 flags)
+trace_i915_gem_ring_dispatch(struct drm_i915_gem_request *req, u32 flags)
 {
-	CTR2(KTR_DRM, "ring_dispatch req %p flags %x", req, flags);
+	DRM_TRACE3("i915_gem_ring_dispatch", req->engine->id, req->fence.seqno,
+	    flags);
 }
 
 static inline void
 trace_i915_gem_object_create(struct drm_i915_gem_object *obj)
 {
-	CTR1(KTR_DRM, "object_create %p", obj);
+	DRM_TRACE2("i915_gem_object_create", (uintptr_t)obj, obj->base.size);
 }
 
 static inline void
 trace_i915_gem_object_pread(struct drm_i915_gem_object *obj, u64 offset, u64 size)
 {
-	CTR3(KTR_DRM, "pread %p %jx %jx", obj, offset, size);
+	DRM_TRACE3("i915_gem_object_pread", (uintptr_t)obj, offset, size);
 }
 
 static inline void
 trace_i915_gem_object_pwrite(struct drm_i915_gem_object *obj, u64 offset, u64 size)
 {
-	CTR3(KTR_DRM, "pwrite %p %jx %jx", obj, offset, size);
-}
-#if 0
-static inline void
-trace_i915_gem_request_wait_end(struct intel_ring_buffer *ring, u32 seqno)
-{
-	CTR2(KTR_DRM, "request_wait_end %s %d", ring->name, seqno);
-}
-
-static inline void
-trace_i915_gem_request_add(struct intel_ring_buffer *ring, u32 seqno)
-{
-	CTR2(KTR_DRM, "request_add %s %d", ring->name, seqno);
-}
-
-static inline void
-trace_i915_gem_request_retire(struct intel_ring_buffer *ring, u32 seqno)
-{
-	CTR2(KTR_DRM, "retire_request_seqno_passed %s %d",
-		ring->name, seqno);
+	DRM_TRACE3("i915_gem_object_pwrite", (uintptr_t)obj, offset, size);
 }
 
-#endif
 static inline void
 trace_i915_gem_object_change_domain(struct drm_i915_gem_object *obj, u32 old_read_domains, u32 old_write_domain)
 {
-	CTR3(KTR_DRM, "object_change_domain  %p %x %x",
-		obj, old_read_domains, old_write_domain);
-}
-
-#if 0
-static inline void
-trace_i915_gem_request_wait_begin(struct intel_ring_buffer *ring, u32 seqno)
-{
-	CTR2(KTR_DRM, "request_wait_begin %s %d", ring->name, seqno);
+	DRM_TRACE3("i915_gem_object_change_domain", (uintptr_t)obj,
+	    old_read_domains, old_write_domain);
 }
-#endif
 
 static inline void
 trace_i915_gem_object_unbind(struct drm_i915_gem_object *obj)
 {
-	CTR1(KTR_DRM, "object_unbind %p", obj);
+	DRM_TRACE1("i915_gem_object_unbind", (uintptr_t)obj);
 }
 
 static inline void
 trace_i915_gem_object_clflush(struct drm_i915_gem_object *obj)
 {
-	CTR1(KTR_DRM, "object_clflush %p", obj);
+	DRM_TRACE1("i915_gem_object_clflush", (uintptr_t)obj);
 }
 
 static inline void
 trace_i915_gem_object_bind(struct drm_i915_gem_object *obj, bool map_and_fenceable)
 {
-	CTR3(KTR_DRM, "object_bind %p %x %d", obj,
-		obj->base.size, map_and_fenceable);
+	DRM_TRACE3("i915_gem_object_bind", (uintptr_t)obj,
+	    obj->base.size, map_and_fenceable);
 }
 
 static inline void
 trace_i915_gem_object_destroy(struct drm_i915_gem_object *obj)
 {
-	CTR1(KTR_DRM, "object_destroy_tail %p", obj);
+	DRM_TRACE1("i915_gem_object_destroy", (uintptr_t)obj);
 }
 
 #define trace_i915_gem_evict(vm, min_size, alignment, flags) \
-CTR4(KTR_DRM, "evict_something %p %d %u %x", vm, min_size, alignment, flags)
+DRM_TRACE4("i915_gem_evict", (uintptr_t)(vm), min_size, alignment, flags)
 
 static inline void
 trace_i915_gem_evict_vm(struct i915_address_space *vm)
 {
-	CTR1(KTR_DRM, "evict_vm %p", vm);
+	DRM_TRACE1("i915_gem_evict_vm", (uintptr_t)vm);
 }
 
 static inline void
 trace_i915_gem_evict_everything(struct drm_device *dev){
-	CTR1(KTR_DRM, "evict_everything %p", dev);
+	DRM_TRACE1("i915_gem_evict_everything", (uintptr_t)dev);
 }
 
 static inline void
 trace_i915_gem_object_fault(void *obj, off_t off, int bit, int write)
 {
-	CTR4(KTR_DRM, "gem_object_fault obj %p off %zd bit %d write: %d", obj, off, bit, write);
+	DRM_TRACE4("i915_gem_object_fault", (uintptr_t)obj, off, bit, write);
 }
 
 static inline void
 trace_i915_gem_shrink(void *dev, int target, int flags)
 {
-	CTR3(KTR_DRM, "gem_shrink %p %d %x", dev, target, flags);
+	DRM_TRACE3("i915_gem_shrink", (uintptr_t)dev, target, flags);
 }
 
 static inline void
 trace_switch_mm(void *ring, void *to) {
-	CTR2(KTR_DRM, "switch_mm ring %p to %p", ring, to);
+	DRM_TRACE2("switch_mm", (uintptr_t)ring, (uintptr_t)to);
 }
 
 static inline void
 trace_i915_context_create(void *ctx) {
-	CTR1(KTR_DRM, "context_create ctx %p", ctx);
+	DRM_TRACE1("i915_context_create", (uintptr_t)ctx);
 }
 
 static inline void
 trace_i915_context_free(void *ctx) {
-	CTR1(KTR_DRM, "context_free ctx %p", ctx);
+	DRM_TRACE1("i915_context_free", (uintptr_t)ctx);
 }
 
 static inline void
-trace_i915_gem_request_wait_begin(void *req) {
-	CTR1(KTR_DRM, "request_wait_begin req %p", req);
+trace_i915_gem_request_wait_begin(struct drm_i915_gem_request *req)
+{
+	DRM_TRACE_EVENT('B', "i915_gem_request_wait", 2, req->engine->id,
+	    req->fence.seqno, 0, 0);
 }
 
 static inline void
-trace_i915_gem_request_wait_end(void *req) {
-	CTR1(KTR_DRM, "request_wait_end req %p", req);
+trace_i915_gem_request_wait_end(struct drm_i915_gem_request *req)
+{
+	DRM_TRACE_EVENT('E', "i915_gem_request_wait", 2, req->engine->id,
+	    req->fence.seqno, 0, 0);
 }
 
 static inline void
-trace_i915_gem_request_retire(void *req) {
-	CTR1(KTR_DRM, "request_retire req %p", req);
+trace_i915_gem_request_retire(struct drm_i915_gem_request *req)
+{
+	DRM_TRACE2("i915_gem_request_retire", req->engine->id,
+	    req->fence.seqno);
 }
 
 static inline void
-trace_i915_gem_request_notify(void *req) {
-	CTR1(KTR_DRM, "request_notify req %p", req);
+trace_i915_gem_request_notify(struct intel_engine_cs *engine)
+{
+	DRM_TRACE2("i915_gem_request_notify", engine->id,
+	    intel_engine_get_seqno(engine));
 }
 
 static inline void
 trace_i915_page_table_entry_alloc(void *vm, uint32_t pde, uint64_t start, int shift)
 {
-	CTR4(KTR_DRM, "page_table_entry_alloc vm %p pde %x start %zx shift %x", vm, pde, start, shift);
+	DRM_TRACE4("i915_page_table_entry_alloc", (uintptr_t)vm, pde, start, shift);
 }
 
 static inline void
 trace_i915_page_directory_entry_alloc(void *vm, uint32_t pdpe, uint64_t start, int shift)
 {
-	CTR4(KTR_DRM, "page_table_directory_entry_alloc vm %p pdpe %x start %zx shift %x", vm, pdpe, start, shift);
+	DRM_TRACE4("i915_page_directory_entry_alloc", (uintptr_t)vm, pdpe, start, shift);
 }
 
 static inline void
 trace_i915_page_directory_pointer_entry_alloc(void *vm, uint32_t pml4e, uint64_t start, int shift)
 {
-	CTR4(KTR_DRM, "page_table_directory_pointer_entry_alloc vm %p pml4e %x start %zx shift %x", vm, pml4e, start, shift);
+	DRM_TRACE4("i915_page_directory_pointer_entry_alloc", (uintptr_t)vm, pml4e, start, shift);
 }
 
 static inline void
 trace_i915_page_table_entry_map(void *base, uint32_t pde, void *pt, int index, int count, uint32_t flags)
 {
-	CTR6(KTR_DRM, "page_table_entry_map base %p pde %x pt %p index %x count %d flags %x", base, pde, pt, index, count, flags);
+	DRM_TRACE4("i915_page_table_entry_map", (uintptr_t)base, pde, index, count);
 }
 
 static inline void
 trace_i915_pipe_update_start(void *crtc)
 {
-	CTR1(KTR_DRM, "pipe_update_start %p", crtc);
+	DRM_TRACE_BEGIN1("i915_pipe_update", (uintptr_t)crtc);
 }
 
 static inline void
 trace_i915_pipe_update_vblank_evaded(void *crtc)
 {
-	CTR1(KTR_DRM, "pipe_update_vblank_evaded %p", crtc);
+	DRM_TRACE1("i915_pipe_update_vblank_evaded", (uintptr_t)crtc);
 }
 
 static inline void
 trace_i915_pipe_update_end(void *crtc, u32 end_vbl_count, int scanline_end)
 {
-	CTR3(KTR_DRM, "pipe_update_end %p end_vbl_count %d scanline_end %d", crtc, end_vbl_count, scanline_end);
+	DRM_TRACE_END1("i915_pipe_update", (uintptr_t)crtc);
+	DRM_TRACE3("i915_pipe_update_end", (uintptr_t)crtc, end_vbl_count, scanline_end);
 }
+
 static inline void
-trace_i915_gem_request_add(void *req)
+trace_i915_gem_request_add(struct drm_i915_gem_request *req)
 {
-	CTR1(KTR_DRM, "gem_request_add req %p", req);
+	DRM_TRACE2("i915_gem_request_add", req->engine->id, req->fence.seqno);
 }
 
 #define trace_i915_gem_ring_sync_to(to_req, from) \
-CTR2(KTR_DRM, "gem_ring_sync_to  to_req %p from %p", to_req, from);
-
+DRM_TRACE4("i915_gem_ring_sync_to", (to_req)->engine->id, (to_req)->fence.seqno, \
+	    (from)->engine->id, (from)->fence.seqno)
 
 static inline void
 trace_i915_vma_bind(void *vma, uint32_t flags)
 {
-	CTR2(KTR_DRM, "vma_bind vma %p flags %x", vma, flags);
+	DRM_TRACE2("i915_vma_bind", (uintptr_t)vma, flags);
 }
 
-
 static inline void
 trace_i915_va_alloc(void *vma)
 {
-	CTR1(KTR_DRM, "va_alloc vma %p", vma);
+	DRM_TRACE1("i915_va_alloc", (uintptr_t)vma);
 }
 
 static inline void
 trace_i915_vma_unbind(void *vma)
 {
-	CTR1(KTR_DRM, "vma_bind vma %p", vma);
+	DRM_TRACE1("i915_vma_unbind", (uintptr_t)vma);
 }
 
 static inline void
 trace_intel_gpu_freq_change(uint32_t freq)
 {
-	CTR1(KTR_DRM, "gpu_freq_change %x", freq);
+	DRM_TRACE1("intel_gpu_freq_change", freq);
 }
 
 static inline void
 trace_i915_ppgtt_create(void *base)
 {
 
-	CTR1(KTR_DRM, "ppgtt_create %p", base);
+	DRM_TRACE1("i915_ppgtt_create", (uintptr_t)base);
 }
 
 static inline void
 trace_i915_ppgtt_release(void *base)
 {
 
-	CTR1(KTR_DRM, "ppgtt_release %p", base);
+	DRM_TRACE1("i915_ppgtt_release", (uintptr_t)base);
 }
 
 static inline void
@@ -1288,6 +1288,7 @@ intel_dp_aux_init(struct intel_dp *intel_dp)
 	/* Failure to allocate our preferred name is not critical */
 	intel_dp->aux.name = kasprintf(GFP_KERNEL, "DPDDC-%c", port_name(port));
 	intel_dp->aux.transfer = intel_dp_aux_transfer;
+	intel_dp->aux.dpcd_cache_enabled = true;
 }
 
 static int
@@ -4056,6 +4057,13 @@ intel_dp_short_pulse(struct intel_dp *intel_dp)
 	intel_dp->compliance_test_type = 0;
 	intel_dp->compliance_test_data = 0;
 
+	/*
+	 * A short pulse may signal a change of the branch device's
+	 * downstream ports, and the DPCD read below doubles as a check
+	 * that the sink is still there, so it must reach the sink.
+	 */
+	drm_dp_dpcd_cache_flush(&intel_dp->aux);
+
 	/*
 	 * Now read the DPCD to see if it's actually running
 	 * If the current value of sink count doesn't match with
@@ -4361,6 +4369,9 @@ intel_dp_long_pulse(struct intel_connector *intel_connector)
 	power_domain = intel_display_port_aux_power_domain(intel_encoder);
 	intel_display_power_get(to_i915(dev), power_domain);
 
+	/* The sink may have been swapped since we last looked. */
+	drm_dp_dpcd_cache_flush(&intel_dp->aux);
+
 	/* Can't disconnect eDP, but you can close the lid... */
 	if (is_edp(intel_dp))
 		status = edp_detect(intel_dp);
@@ -4827,6 +4838,7 @@ intel_dp_hpd_pulse(struct intel_digital_port *intel_dig_port, bool long_hpd)
 		      long_hpd ? "long" : "short");
 
 	if (long_hpd) {
+		drm_dp_dpcd_cache_flush(&intel_dp->aux);
 		intel_dp->detect_done = false;
 		return IRQ_NONE;
 	}
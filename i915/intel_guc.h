@@ -87,6 +87,11 @@ struct i915_guc_client {
 	uint32_t b_fail;
 	int retcode;
 
+	/* Work items appended since the doorbell was last rung */
+	uint32_t wq_pending;
+	uint64_t doorbells;
+	struct tasklet_struct db_tasklet;
+
 	/* Per-engine counts of GuC submissions */
 	uint64_t submissions[I915_NUM_ENGINES];
 };
@@ -143,6 +148,13 @@ struct intel_guc {
 	uint32_t action_status;		/* Last return status		*/
 	uint32_t action_fail;		/* Total number of failures	*/
 	int32_t action_err;		/* Last error code		*/
+	uint64_t action_coalesced;	/* Merged into a queued action	*/
+	uint64_t action_time_us;	/* Total queue + mailbox time	*/
+
+	/* Queued actions, see host2guc_action_queue() */
+	spinlock_t action_lock;
+	struct list_head action_list;
+	struct work_struct action_work;
 
 	uint64_t submissions[I915_NUM_ENGINES];
 	uint32_t last_seqno[I915_NUM_ENGINES];
@@ -163,5 +175,7 @@ int i915_guc_wq_reserve(struct drm_i915_gem_request *rq);
 void i915_guc_wq_unreserve(struct drm_i915_gem_request *request);
 void i915_guc_submission_disable(struct drm_i915_private *dev_priv);
 void i915_guc_submission_fini(struct drm_i915_private *dev_priv);
+void i915_guc_action_init(struct intel_guc *guc);
+void i915_guc_action_fini(struct intel_guc *guc);
 
 #endif
@@ -901,9 +901,8 @@ struct drm_device {
 	u32 max_vblank_count;           /**< size of vblank counter register */
 
 	/**
-	 * List of events
+	 * Protects the per-pipe vblank event lists and event delivery
 	 */
-	struct list_head vblank_event_list;
 	spinlock_t event_lock;
 
 	/*@} */
@@ -532,6 +532,8 @@ struct drm_cmdline_mode {
  * @null_edid_counter: track sinks that give us all zeros for the EDID
  * @bad_edid_counter: track sinks that give us an EDID with invalid checksum
  * @edid_corrupt: indicates whether the last read EDID was corrupt
+ * @edid_cache: last EDID read in full, reused while its base block is unchanged
+ * @edid_cache_hits: number of EDID reads whose extensions came from @edid_cache
  * @debugfs_entry: debugfs directory for this connector
  * @state: current atomic state for this connector
  * @has_tile: is this connector connected to a tiled monitor
@@ -670,6 +672,9 @@ struct drm_connector {
 	 */
 	bool edid_corrupt;
 
+	struct edid *edid_cache;
+	unsigned edid_cache_hits;
+
 	struct dentry *debugfs_entry;
 
 	struct drm_connector_state *state;
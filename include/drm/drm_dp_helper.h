@@ -709,6 +709,8 @@ struct drm_dp_aux_msg {
 	size_t size;
 };
 
+#define DP_DPCD_CACHE_SIZE 0x100
+
 /**
  * struct drm_dp_aux - DisplayPort AUX channel
  * @name: user-visible name of this AUX channel and the I2C-over-AUX adapter
@@ -761,12 +763,44 @@ struct drm_dp_aux {
 	 * @i2c_defer_count: Counts I2C DEFERs, used for DP validation.
 	 */
 	unsigned i2c_defer_count;
+	/**
+	 * @dpcd_cache_enabled: Serve reads of the read-only receiver
+	 * capability field (DPCD 0x000-0x0ff) from @dpcd_cache once they have
+	 * been read from the sink. Drivers opting in must call
+	 * drm_dp_dpcd_cache_flush() whenever the sink may have changed, e.g.
+	 * on HPD pulses, long or short: a short pulse can report a change of
+	 * a branch device's downstream ports (DPCD 0x080 onwards).
+	 */
+	bool dpcd_cache_enabled;
+	/**
+	 * @dpcd_cache: Cached receiver capability bytes.
+	 */
+	u8 dpcd_cache[DP_DPCD_CACHE_SIZE];
+	/**
+	 * @dpcd_cache_valid: Bitmap of valid bytes in @dpcd_cache.
+	 */
+	unsigned long dpcd_cache_valid[BITS_TO_LONGS(DP_DPCD_CACHE_SIZE)];
+	/**
+	 * @dpcd_cache_seqno: Bumped on every flush, so that a read racing
+	 * with a flush does not repopulate the cache with stale data.
+	 */
+	unsigned dpcd_cache_seqno;
+	/**
+	 * @dpcd_cache_hits: Counts DPCD reads served from @dpcd_cache.
+	 */
+	unsigned dpcd_cache_hits;
+	/**
+	 * @dpcd_cache_misses: Counts cacheable DPCD reads that went to the
+	 * sink.
+	 */
+	unsigned dpcd_cache_misses;
 };
 
 ssize_t drm_dp_dpcd_read(struct drm_dp_aux *aux, unsigned int offset,
 			 void *buffer, size_t size);
 ssize_t drm_dp_dpcd_write(struct drm_dp_aux *aux, unsigned int offset,
 			  void *buffer, size_t size);
+void drm_dp_dpcd_cache_flush(struct drm_dp_aux *aux);
 
 /**
  * drm_dp_dpcd_readb() - read a single byte from the DPCD
@@ -164,6 +164,9 @@ struct drm_fb_helper_connector {
 	struct drm_connector *connector;
 };
 
+/* damage rectangles tracked between two flushes of the fbdev emulation */
+#define DRM_FB_HELPER_MAX_DIRTY_CLIPS 4
+
 /**
  * struct drm_fb_helper - main structure to emulate fbdev on top of KMS
  * @fb: Scanout framebuffer object
@@ -176,9 +179,10 @@ struct drm_fb_helper_connector {
  * @funcs: driver callbacks for fb helper
  * @fbdev: emulated fbdev device info struct
  * @pseudo_palette: fake palette of 16 colors
- * @dirty_clip: clip rectangle used with deferred_io to accumulate damage to
- *              the screen buffer
- * @dirty_lock: spinlock protecting @dirty_clip
+ * @dirty_clips: disjoint clip rectangles used with deferred_io to accumulate
+ *               damage to the screen buffer
+ * @num_dirty_clips: number of valid entries in @dirty_clips
+ * @dirty_lock: spinlock protecting @dirty_clips and @num_dirty_clips
  * @dirty_work: worker used to flush the framebuffer
  * @resume_work: worker used during resume if the console lock is already taken
  *
@@ -198,7 +202,8 @@ struct drm_fb_helper {
 	const struct drm_fb_helper_funcs *funcs;
 	struct fb_info *fbdev;
 	u32 pseudo_palette[17];
-	struct drm_clip_rect dirty_clip;
+	struct drm_clip_rect dirty_clips[DRM_FB_HELPER_MAX_DIRTY_CLIPS];
+	unsigned int num_dirty_clips;
 	spinlock_t dirty_lock;
 	struct work_struct dirty_work;
 	struct work_struct resume_work;
@@ -42,6 +42,13 @@ struct drm_pending_vblank_event {
 	 * @event: Actual event which will be sent to userspace.
 	 */
 	struct drm_event_vblank event;
+	/**
+	 * @due_sequence: First vblank count at which the event is sent while
+	 * queued on &drm_vblank_crtc.event_list. This is the target sequence
+	 * for events from DRM_IOCTL_WAIT_VBLANK, and the vblank after the one
+	 * they were armed on for drm_crtc_arm_vblank_event().
+	 */
+	unsigned int due_sequence;
 };
 
 /**
@@ -128,6 +135,32 @@ struct drm_vblank_crtc {
 	 * disabling functions multiple times.
 	 */
 	bool enabled;
+	/**
+	 * @event_list: Pending vblank events for this pipe, sorted by due
+	 * sequence so that vblank handling only touches events which are due.
+	 * Protected by &drm_device.event_lock.
+	 */
+	struct list_head event_list;
+	/**
+	 * @events_sent: Number of events delivered from @event_list. This and
+	 * the other event statistics below are protected by
+	 * &drm_device.event_lock.
+	 */
+	u64 events_sent;
+	/**
+	 * @events_late: Number of events delivered one or more vblanks after
+	 * their &drm_pending_vblank_event.due_sequence.
+	 */
+	u64 events_late;
+	/**
+	 * @delivery_ns: Accumulated time between the vblank timestamp and
+	 * the delivery of each event.
+	 */
+	u64 delivery_ns;
+	/**
+	 * @delivery_max_ns: Worst case of @delivery_ns for a single event.
+	 */
+	u64 delivery_max_ns;
 };
 
 extern int drm_irq_install(struct drm_device *dev, int irq);
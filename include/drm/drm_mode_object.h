@@ -59,6 +59,7 @@ struct drm_mode_object {
 };
 
 #define DRM_OBJECT_MAX_PROPERTY 24
+#define DRM_OBJECT_PROP_HASH_SIZE 64
 /**
  * struct drm_object_properties - property tracking for &drm_mode_object
  */
@@ -93,6 +94,14 @@ struct drm_object_properties {
 	 * without the DRM_MODE_PROP_IMMUTABLE flag set.
 	 */
 	uint64_t values[DRM_OBJECT_MAX_PROPERTY];
+
+	/**
+	 * @index: Open-addressed hash of property ids, used by
+	 * drm_mode_obj_find_prop_id() to avoid scanning @properties. Each slot
+	 * holds the @properties index plus one, zero marks an empty slot.
+	 * Maintained by drm_object_attach_property().
+	 */
+	uint8_t index[DRM_OBJECT_PROP_HASH_SIZE];
 };
 
 /* Avoid boilerplate.  I'm tired of typing. */
@@ -16,6 +16,7 @@ __FBSDID("$FreeBSD$");
 #include <sys/proc.h>
 #include <sys/resourcevar.h>
 #include <sys/sbuf.h>
+#include <sys/sx.h>
 #include <sys/smp.h>
 #include <sys/socket.h>
 #include <sys/vnode.h>
@@ -49,11 +50,27 @@ MALLOC_DEFINE(M_DFSINT, "debugfsint", "Linux debugfs internal");
 
 static struct pfs_node *debugfs_root;
 
+/* streams kept per file for sequential readers, see debugfs_fill_read() */
+#define	DEBUGFS_MAX_STREAMS	4
+/* bytes generated per call into the file's read method */
+#define	DEBUGFS_READ_CHUNK	(16 * PAGE_SIZE)
+
+struct debugfs_stream {
+	TAILQ_ENTRY(debugfs_stream) ds_link;
+	pid_t ds_pid;
+	off_t ds_pos;
+	struct vnode ds_vn;
+	struct linux_file ds_lf;
+};
+
 struct dentry_meta {
 	struct dentry dm_dnode;
 	const struct file_operations *dm_fops;
 	void *dm_data;
 	umode_t dm_mode;
+	struct sx dm_lock;
+	TAILQ_HEAD(debugfs_stream_head, debugfs_stream) dm_streams;
+	int dm_nstreams;
 };
 
 static int
@@ -67,16 +84,183 @@ debugfs_attr(PFS_ATTR_ARGS)
 	return (0);
 }
 
+static int
+debugfs_stream_open(struct dentry_meta *d, struct debugfs_stream **dsp)
+{
+	struct debugfs_stream *ds;
+	int rc;
+
+	ds = malloc(sizeof(*ds), M_DFSINT, M_WAITOK | M_ZERO);
+	ds->ds_vn.v_data = d->dm_data;
+	rc = d->dm_fops->open(&ds->ds_vn, &ds->ds_lf);
+	if (rc < 0) {
+#ifdef INVARIANTS
+		printf("open failed with %d\n", rc);
+#endif
+		free(ds, M_DFSINT);
+		return (-rc);
+	}
+	*dsp = ds;
+	return (0);
+}
+
+static void
+debugfs_stream_close(struct dentry_meta *d, struct debugfs_stream *ds)
+{
+
+	if (d->dm_fops->release)
+		d->dm_fops->release(&ds->ds_vn, &ds->ds_lf);
+	else
+		single_release(&ds->ds_vn, &ds->ds_lf);
+	free(ds, M_DFSINT);
+}
+
+/*
+ * Take the stream of process pid that stopped at offset off, if there
+ * is one.
+ */
+static struct debugfs_stream *
+debugfs_stream_get(struct dentry_meta *d, pid_t pid, off_t off)
+{
+	struct debugfs_stream *ds;
+
+	sx_xlock(&d->dm_lock);
+	TAILQ_FOREACH(ds, &d->dm_streams, ds_link) {
+		if (ds->ds_pid == pid && ds->ds_pos == off) {
+			TAILQ_REMOVE(&d->dm_streams, ds, ds_link);
+			d->dm_nstreams--;
+			break;
+		}
+	}
+	sx_xunlock(&d->dm_lock);
+	return (ds);
+}
+
+/*
+ * Keep a stream around for the next read, dropping the least recently
+ * used one if there are too many.
+ */
+static void
+debugfs_stream_put(struct dentry_meta *d, struct debugfs_stream *ds)
+{
+	struct debugfs_stream *old = NULL;
+
+	sx_xlock(&d->dm_lock);
+	TAILQ_INSERT_HEAD(&d->dm_streams, ds, ds_link);
+	if (++d->dm_nstreams > DEBUGFS_MAX_STREAMS) {
+		old = TAILQ_LAST(&d->dm_streams, debugfs_stream_head);
+		TAILQ_REMOVE(&d->dm_streams, old, ds_link);
+		d->dm_nstreams--;
+	}
+	sx_xunlock(&d->dm_lock);
+	if (old != NULL)
+		debugfs_stream_close(d, old);
+}
+
+static int
+debugfs_close(PFS_CLOSE_ARGS)
+{
+	struct dentry_meta *d;
+	struct debugfs_stream *ds, *tmp;
+	TAILQ_HEAD(, debugfs_stream) dead;
+
+	d = pn->pn_data;
+	TAILQ_INIT(&dead);
+	sx_xlock(&d->dm_lock);
+	TAILQ_FOREACH_SAFE(ds, &d->dm_streams, ds_link, tmp) {
+		if (ds->ds_pid == td->td_proc->p_pid) {
+			TAILQ_REMOVE(&d->dm_streams, ds, ds_link);
+			d->dm_nstreams--;
+			TAILQ_INSERT_TAIL(&dead, ds, ds_link);
+		}
+	}
+	sx_xunlock(&d->dm_lock);
+	TAILQ_FOREACH_SAFE(ds, &dead, ds_link, tmp)
+		debugfs_stream_close(d, ds);
+	return (0);
+}
+
 static int
 debugfs_destroy(PFS_DESTROY_ARGS)
 {
 	struct dentry_meta *d;
+	struct debugfs_stream *ds;
 
 	d = pn->pn_data;
+	while ((ds = TAILQ_FIRST(&d->dm_streams)) != NULL) {
+		TAILQ_REMOVE(&d->dm_streams, ds, ds_link);
+		debugfs_stream_close(d, ds);
+	}
+	if (d->dm_fops != NULL)
+		sx_destroy(&d->dm_lock);
 	free(d, M_DFSINT);
 	return (0);
 }
 
+/*
+ * Reads bypass the pseudofs sbuf (PFS_RAWRD) and resume the stream the
+ * reading process left at uio_offset, so sequential chunked reads of a
+ * large seq_file only generate every record once.  A read at any other
+ * offset opens a new stream, which seq_read fast-forwards.
+ */
+static int
+debugfs_fill_read(struct dentry_meta *d, struct uio *uio)
+{
+	struct debugfs_stream *ds;
+	struct seq_file *sf;
+	struct sbuf *sb;
+	pid_t pid;
+	ssize_t n;
+	loff_t off;
+	bool eof;
+	int rc;
+
+	pid = curproc->p_pid;
+	ds = debugfs_stream_get(d, pid, uio->uio_offset);
+	if (ds == NULL) {
+		rc = debugfs_stream_open(d, &ds);
+		if (rc)
+			return (rc);
+		ds->ds_pid = pid;
+	}
+
+	sb = sbuf_new(NULL, NULL, DEBUGFS_READ_CHUNK, SBUF_AUTOEXTEND);
+	sf = ds->ds_lf.private_data;
+	off = uio->uio_offset;
+	eof = false;
+	rc = 0;
+	while (uio->uio_resid > 0) {
+		sbuf_clear(sb);
+		sf->buf = sb;
+		n = d->dm_fops->read(&ds->ds_lf, NULL,
+		    MIN(uio->uio_resid, DEBUGFS_READ_CHUNK), &off);
+		if (n <= 0) {
+#ifdef INVARIANTS
+			if (n < 0)
+				printf("read return %zd\n", n);
+#endif
+			rc = -n;
+			eof = true;
+			break;
+		}
+		if (sbuf_finish(sb)) {
+			rc = ENOMEM;
+			break;
+		}
+		rc = uiomove(sbuf_data(sb), sbuf_len(sb), uio);
+		if (rc)
+			break;
+	}
+	sbuf_delete(sb);
+
+	ds->ds_pos = off;
+	if (eof || rc)
+		debugfs_stream_close(d, ds);
+	else
+		debugfs_stream_put(d, ds);
+	return (rc);
+}
+
 static int
 debugfs_fill(PFS_FILL_ARGS)
 {
@@ -93,6 +277,9 @@ debugfs_fill(PFS_FILL_ARGS)
 
 	if ((rc = linux_set_current_flags(curthread, M_NOWAIT)))
 		return (rc);
+	if (uio->uio_rw == UIO_READ)
+		return (debugfs_fill_read(d, uio));
+
 	vn.v_data = d->dm_data;
 	buf = uio->uio_iov[0].iov_base;
 	len = min(uio->uio_iov[0].iov_len, uio->uio_resid);
@@ -107,10 +294,7 @@ debugfs_fill(PFS_FILL_ARGS)
 	}
 	sf = lf.private_data;
 	sf->buf = sb;
-	if (uio->uio_rw == UIO_READ)
-		rc = d->dm_fops->read(&lf, NULL, len, &off);
-	else
-		rc = d->dm_fops->write(&lf, buf, len, &off);
+	rc = d->dm_fops->write(&lf, buf, len, &off);
 	if (d->dm_fops->release)
 		d->dm_fops->release(&vn, &lf);
 	else
@@ -142,15 +326,18 @@ debugfs_create_file(const char *name, umode_t mode,
 	dm->dm_fops = fops;
 	dm->dm_data = data;
 	dm->dm_mode = mode;
+	sx_init(&dm->dm_lock, "debugfs streams");
+	TAILQ_INIT(&dm->dm_streams);
 	if (parent != NULL)
 		pnode = parent->d_pfs_node;
 	else
 		pnode = debugfs_root;
 	
-	flags = fops->write ? PFS_RDWR : PFS_RD;
+	flags = (fops->write ? PFS_RDWR : PFS_RD) | PFS_RAWRD;
 	dnode->d_pfs_node = pfs_create_file(pnode, name, debugfs_fill,
 	    debugfs_attr, NULL, debugfs_destroy, flags);
 	dnode->d_pfs_node->pn_data = dm;
+	dnode->d_pfs_node->pn_close = debugfs_close;
 
 	return (dnode);
 }
@@ -167,6 +354,7 @@ debugfs_create_dir(const char *name, struct dentry *parent)
 		return (NULL);
 	dnode = &dm->dm_dnode;
 	dm->dm_mode = 0700;
+	TAILQ_INIT(&dm->dm_streams);
 	if (parent != NULL)
 		pnode = parent->d_pfs_node;
 	else
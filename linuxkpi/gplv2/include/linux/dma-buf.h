@@ -35,6 +35,10 @@
 #include <linux/wait.h>
 #include <linux/module.h>
 
+#include <sys/_mutex.h>
+#include <sys/_task.h>
+#include <sys/selinfo.h>
+
 struct device;
 struct dma_buf;
 struct dma_buf_attachment;
@@ -113,10 +117,17 @@ struct dma_buf {
 
 	/* poll support */
 	wait_queue_head_t poll;
+	struct selinfo poll_sel;	/* poll(2) and kqueue(2) waiters */
+	struct mtx poll_mtx;		/* knlist lock */
+	spinlock_t poll_lock;		/* protects cb_*.active */
+	struct task poll_task;		/* wakes waiters outside fence locks */
 
 	struct dma_buf_poll_cb_t {
 		struct fence_cb cb;
 		wait_queue_head_t *poll;
+		struct dma_buf *dmabuf;
+		/* fence cb is armed on, referenced until the task drops it */
+		struct fence *fence;
 
 		unsigned long active;
 	} cb_excl, cb_shared;
@@ -34,12 +34,21 @@
 
 struct seq_operations;
 
+#define	SEQ_SKIP	1
+
 struct seq_file {
-	struct sbuf	*buf;
+	struct sbuf	*buf;		/* show() output goes here */
 
 	const struct seq_operations *op;
 	const struct linux_file *file;
 	void *private;
+
+	/* iteration state for seq_read */
+	struct sbuf	*rec;		/* last record generated by show() */
+	size_t		count;		/* bytes in rec */
+	size_t		from;		/* bytes of rec already returned */
+	loff_t		index;		/* iterator position of the next record */
+	loff_t		read_pos;	/* stream offset returned so far */
 };
 
 struct seq_operations {
@@ -53,6 +62,8 @@ ssize_t linux_seq_read(struct file *, char __user *, size_t, loff_t *);
 int seq_write(struct seq_file *seq, const void *data, size_t len);
 
 loff_t seq_lseek(struct file *file, loff_t offset, int whence);
+int seq_open(struct file *, const struct seq_operations *);
+int seq_release(struct inode *, struct file *);
 int single_open(struct file *, int (*)(struct seq_file *, void *), void *);
 int single_release(struct inode *, struct file *);
 
@@ -0,0 +1,14 @@
+#ifndef _LINUX_GPLV2_SHMEM_FS_H_
+#define _LINUX_GPLV2_SHMEM_FS_H_
+
+#include_next <linux/shmem_fs.h>
+
+/*
+ * Wire up to count consecutive pages of a shmem object starting at
+ * pindex with a single object lock hold.  Returns the number of pages
+ * stored in pages[], which is short if a page could not be paged in.
+ */
+int shmem_read_mapping_pages_gfp(vm_object_t obj, vm_pindex_t pindex,
+    int count, gfp_t gfp, struct page **pages);
+
+#endif	/* _LINUX_GPLV2_SHMEM_FS_H_ */
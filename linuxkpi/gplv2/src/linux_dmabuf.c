@@ -43,6 +43,10 @@ __FBSDID("$FreeBSD$");
 #include <sys/filio.h>
 #include <sys/unistd.h>
 #include <sys/capsicum.h>
+#include <sys/event.h>
+#include <sys/poll.h>
+#include <sys/selinfo.h>
+#include <sys/taskqueue.h>
 
 #include <vm/vm.h>
 #include <vm/pmap.h>
@@ -71,6 +75,7 @@ static fo_stat_t dma_buf_stat;
 static fo_fill_kinfo_t dma_buf_fill_kinfo;
 static fo_mmap_t dma_buf_mmap_fileops;
 static fo_poll_t dma_buf_poll;
+static fo_kqfilter_t dma_buf_kqfilter;
 static fo_seek_t dma_buf_seek;
 static fo_ioctl_t dma_buf_ioctl;
 
@@ -80,6 +85,7 @@ struct fileops dma_buf_fileops  = {
 	.fo_fill_kinfo = dma_buf_fill_kinfo,
 	.fo_mmap = dma_buf_mmap_fileops,
 	.fo_poll = dma_buf_poll,
+	.fo_kqfilter = dma_buf_kqfilter,
 	.fo_seek = dma_buf_seek,
 	.fo_ioctl = dma_buf_ioctl,
 	.fo_flags = DFLAG_PASSABLE|DFLAG_SEEKABLE,
@@ -90,6 +96,9 @@ struct fileops dma_buf_fileops  = {
 
 #define fp_is_db(fp) ((fp)->f_ops == &dma_buf_fileops)
 
+static void dma_buf_poll_disarm(struct dma_buf *db,
+    struct dma_buf_poll_cb_t *dcb);
+
 static int
 dma_buf_close(struct file *fp, struct thread *td)
 {
@@ -100,8 +109,16 @@ dma_buf_close(struct file *fp, struct thread *td)
 
 	db = fp->f_data;
 
-	MPASS(db->cb_shared.active == 0);
-	MPASS(db->cb_excl.active == 0);
+	/* a fence signaling after this must not find our callbacks */
+	dma_buf_poll_disarm(db, &db->cb_excl);
+	dma_buf_poll_disarm(db, &db->cb_shared);
+
+	taskqueue_drain(taskqueue_thread, &db->poll_task);
+	seldrain(&db->poll_sel);
+	knlist_clear(&db->poll_sel.si_note, 0);
+	knlist_destroy(&db->poll_sel.si_note);
+	mtx_destroy(&db->poll_mtx);
+	spin_lock_destroy(&db->poll_lock);
 
 	/* release DMA buffer */
 	db->ops->release(db);
@@ -184,11 +201,293 @@ dma_buf_seek(struct file *fp, off_t offset, int whence, struct thread *td)
 	return (0);
 }
 
+/*
+ * Readiness follows the implicit fencing rules: a buffer is readable once
+ * its exclusive (write) fence has signaled and writable once all of its
+ * fences have.  Instead of sleeping on the fences we arm a callback on them
+ * and let fence signaling wake up poll(2) and kqueue(2) waiters.
+ */
+#define	DB_POLL_READ	0x1
+#define	DB_POLL_WRITE	0x2
+
+/*
+ * Drop the reference on the fence of a callback that has fired.  Done
+ * here rather than in the callback, which runs with the fence lock held.
+ */
+static void
+dma_buf_poll_put_fired(struct dma_buf *db, struct dma_buf_poll_cb_t *dcb)
+{
+	struct fence *fence = NULL;
+
+	spin_lock_irq(&db->poll_lock);
+	if (dcb->active == 0) {
+		fence = dcb->fence;
+		dcb->fence = NULL;
+	}
+	spin_unlock_irq(&db->poll_lock);
+	if (fence != NULL)
+		fence_put(fence);
+}
+
+/* Detach a still armed callback from its fence, for close. */
+static void
+dma_buf_poll_disarm(struct dma_buf *db, struct dma_buf_poll_cb_t *dcb)
+{
+	struct fence *fence;
+
+	spin_lock_irq(&db->poll_lock);
+	fence = dcb->fence;
+	dcb->fence = NULL;
+	spin_unlock_irq(&db->poll_lock);
+
+	if (fence != NULL) {
+		fence_remove_callback(fence, &dcb->cb);
+		fence_put(fence);
+	}
+	dcb->active = 0;
+}
+
+static void
+dma_buf_poll_task(void *arg, int pending __unused)
+{
+	struct dma_buf *db = arg;
+
+	dma_buf_poll_put_fired(db, &db->cb_excl);
+	dma_buf_poll_put_fired(db, &db->cb_shared);
+
+	wake_up_all(&db->poll);
+	selwakeup(&db->poll_sel);
+	KNOTE_UNLOCKED(&db->poll_sel.si_note, 0);
+}
+
+/*
+ * Called with the fence lock held, possibly from interrupt context, so
+ * the actual wakeup is deferred to a task to keep the knlist lock out of
+ * the fence lock order.
+ */
+static void
+dma_buf_poll_cb(struct fence *fence __unused, struct fence_cb *cb)
+{
+	struct dma_buf_poll_cb_t *dcb = (struct dma_buf_poll_cb_t *)cb;
+	struct dma_buf *db = dcb->dmabuf;
+	unsigned long flags;
+
+	spin_lock_irqsave(&db->poll_lock, flags);
+	dcb->active = 0;
+	spin_unlock_irqrestore(&db->poll_lock, flags);
+	taskqueue_enqueue(taskqueue_thread, &db->poll_task);
+}
+
+/*
+ * Arm dcb on fence, taking over the caller's reference.  Returns 0 once
+ * the callback is armed, or an error if the fence has already signaled.
+ */
+static int
+dma_buf_poll_arm(struct dma_buf *db, struct dma_buf_poll_cb_t *dcb,
+    struct fence *fence)
+{
+	struct fence *old;
+	int error;
+
+	spin_lock_irq(&db->poll_lock);
+	old = dcb->fence;
+	dcb->fence = fence;
+	spin_unlock_irq(&db->poll_lock);
+	if (old != NULL)
+		fence_put(old);
+
+	error = fence_add_callback(fence, &dcb->cb, dma_buf_poll_cb);
+	if (error != 0) {
+		spin_lock_irq(&db->poll_lock);
+		dcb->fence = NULL;
+		spin_unlock_irq(&db->poll_lock);
+		fence_put(fence);
+	}
+	return (error);
+}
+
+/*
+ * Nothing to wait for on dcb: report ready without arming a callback or
+ * waking anyone up, fence signaling already did that.
+ */
+static void
+dma_buf_poll_ready(struct dma_buf *db, struct dma_buf_poll_cb_t *dcb)
+{
+
+	spin_lock_irq(&db->poll_lock);
+	dcb->active = 0;
+	spin_unlock_irq(&db->poll_lock);
+}
+
+/*
+ * Returns the subset of DB_POLL_* in events that is ready now.  For the
+ * rest a fence callback is armed (or already pending) that will wake up
+ * waiters once it fires.
+ */
+static int
+dma_buf_poll_events(struct dma_buf *db, int events)
+{
+	struct reservation_object *resv;
+	struct reservation_object_list *fobj;
+	struct fence *fence_excl;
+	unsigned shared_count, seq;
+
+	resv = db->resv;
+	if (resv == NULL || events == 0)
+		return (events);
+
+retry:
+	seq = read_seqcount_begin(&resv->seq);
+	rcu_read_lock();
+
+	fobj = rcu_dereference(resv->fence);
+	if (fobj != NULL)
+		shared_count = fobj->shared_count;
+	else
+		shared_count = 0;
+	fence_excl = rcu_dereference(resv->fence_excl);
+	if (read_seqcount_retry(&resv->seq, seq)) {
+		rcu_read_unlock();
+		goto retry;
+	}
+
+	if (fence_excl != NULL &&
+	    (!(events & DB_POLL_WRITE) || shared_count == 0)) {
+		struct dma_buf_poll_cb_t *dcb = &db->cb_excl;
+		unsigned long pevents = DB_POLL_READ;
+
+		if (shared_count == 0)
+			pevents |= DB_POLL_WRITE;
+
+		spin_lock_irq(&db->poll_lock);
+		if (dcb->active) {
+			dcb->active |= pevents;
+			events &= ~pevents;
+		} else
+			dcb->active = pevents;
+		spin_unlock_irq(&db->poll_lock);
+
+		if (events & pevents) {
+			/* a fence being freed has signaled */
+			if (fence_get_rcu(fence_excl) &&
+			    !dma_buf_poll_arm(db, dcb, fence_excl))
+				events &= ~pevents;
+			else
+				dma_buf_poll_ready(db, dcb);
+		}
+	}
+
+	if ((events & DB_POLL_WRITE) && shared_count > 0) {
+		struct dma_buf_poll_cb_t *dcb = &db->cb_shared;
+		unsigned i;
+
+		/* only queue a new callback if no event has fired yet */
+		spin_lock_irq(&db->poll_lock);
+		if (dcb->active)
+			events &= ~DB_POLL_WRITE;
+		else
+			dcb->active = DB_POLL_WRITE;
+		spin_unlock_irq(&db->poll_lock);
+
+		if (!(events & DB_POLL_WRITE))
+			goto out;
+
+		for (i = 0; i < shared_count; ++i) {
+			struct fence *fence = rcu_dereference(fobj->shared[i]);
+
+			/* skip fences that are being freed or have signaled */
+			if (!fence_get_rcu(fence))
+				continue;
+			if (!dma_buf_poll_arm(db, dcb, fence)) {
+				events &= ~DB_POLL_WRITE;
+				break;
+			}
+		}
+
+		/* every fence has signaled, writable now */
+		if (i == shared_count)
+			dma_buf_poll_ready(db, dcb);
+	}
+out:
+	rcu_read_unlock();
+	return (events);
+}
+
 static int
 dma_buf_poll(struct file *fp, int events,
 	     struct ucred *active_cred, struct thread *td)
 {
-	panic("XXX implement me!!!");
+	struct dma_buf *db;
+	int req, ready, revents;
+
+	if (!fp_is_db(fp))
+		return (POLLNVAL);
+
+	db = fp->f_data;
+	req = 0;
+	if (events & (POLLIN | POLLRDNORM))
+		req |= DB_POLL_READ;
+	if (events & (POLLOUT | POLLWRNORM))
+		req |= DB_POLL_WRITE;
+	if (req == 0)
+		return (0);
+
+	/* record before arming so that a callback firing now is not lost */
+	selrecord(td, &db->poll_sel);
+	ready = dma_buf_poll_events(db, req);
+
+	revents = 0;
+	if (ready & DB_POLL_READ)
+		revents |= events & (POLLIN | POLLRDNORM);
+	if (ready & DB_POLL_WRITE)
+		revents |= events & (POLLOUT | POLLWRNORM);
+	return (revents);
+}
+
+static void
+dma_buf_kqops_detach(struct knote *kn)
+{
+	struct dma_buf *db = kn->kn_hook;
+
+	knlist_remove(&db->poll_sel.si_note, kn, 0);
+}
+
+static int
+dma_buf_kqops_event(struct knote *kn, long hint __unused)
+{
+	struct dma_buf *db = kn->kn_hook;
+	int req;
+
+	req = kn->kn_filter == EVFILT_READ ? DB_POLL_READ : DB_POLL_WRITE;
+	return (dma_buf_poll_events(db, req) != 0);
+}
+
+static struct filterops dma_buf_kqops = {
+	.f_isfd = 1,
+	.f_detach = dma_buf_kqops_detach,
+	.f_event = dma_buf_kqops_event,
+};
+
+static int
+dma_buf_kqfilter(struct file *fp, struct knote *kn)
+{
+	struct dma_buf *db;
+
+	if (!fp_is_db(fp))
+		return (EINVAL);
+
+	db = fp->f_data;
+	switch (kn->kn_filter) {
+	case EVFILT_READ:
+	case EVFILT_WRITE:
+		break;
+	default:
+		return (EINVAL);
+	}
+
+	kn->kn_fop = &dma_buf_kqops;
+	kn->kn_hook = db;
+	knlist_add(&db->poll_sel.si_note, kn, 0);
 	return (0);
 }
 
@@ -372,7 +671,13 @@ dma_buf_export(const struct dma_buf_export_info *exp_info)
 	db->owner = exp_info->owner;
 	init_waitqueue_head(&db->poll);
 	db->cb_excl.poll = db->cb_shared.poll = &db->poll;
+	db->cb_excl.dmabuf = db->cb_shared.dmabuf = db;
 	db->cb_excl.active = db->cb_shared.active = 0;
+	db->cb_excl.fence = db->cb_shared.fence = NULL;
+	spin_lock_init(&db->poll_lock);
+	mtx_init(&db->poll_mtx, "dmabufpoll", NULL, MTX_DEF);
+	knlist_init_mtx(&db->poll_sel.si_note, &db->poll_mtx);
+	TASK_INIT(&db->poll_task, 0, dma_buf_poll_task, db);
 
 	if (ro == NULL) {
 		ro = (struct reservation_object *)&db[1];
@@ -394,6 +699,9 @@ dma_buf_export(const struct dma_buf_export_info *exp_info)
 
 	return (db);
 err:	
+	knlist_destroy(&db->poll_sel.si_note);
+	mtx_destroy(&db->poll_mtx);
+	spin_lock_destroy(&db->poll_lock);
 	free(db, M_DMABUF);
 	return (ERR_PTR(-err));
 }
@@ -30,6 +30,9 @@
 
 #include <sys/lock.h>
 #include <sys/rwlock.h>
+#include <sys/proc.h>
+#include <sys/sched.h>
+#include <sys/sf_buf.h>
 
 #include <machine/atomic.h>
 
@@ -44,6 +47,7 @@
 #include <linux/mm.h>
 #include <linux/page.h>
 #include <linux/pfn_t.h>
+#include <linux/shmem_fs.h>
 #include <linux/vmalloc.h>
 
 #if defined(__amd64__) || defined(__aarch64__) || defined(__riscv__)
@@ -66,6 +70,146 @@ __linux_clflushopt(u_long addr)
 		pmap_invalidate_cache();
 }
 
+#ifndef LINUXKPI_HAVE_DMAP
+/*
+ * Without a direct map every kmap() needs an sf_buf.  Keep the last few
+ * mappings of each CPU around, keyed by page and memory attribute, so
+ * that repeatedly mapping the same pages (relocation processing, for
+ * instance) doesn't go through sf_buf_alloc()/sf_buf_free() every time.
+ * Entries are only touched from their own CPU inside a critical section;
+ * sf_buf_alloc() and sf_buf_free() are called outside of it.
+ */
+#define	KMAP_CACHE_SIZE	8
+
+struct kmap_cache_entry {
+	vm_page_t	page;
+	struct sf_buf	*sf;
+	vm_memattr_t	attr;
+	u_int		refs;
+	u_int		stamp;
+};
+
+struct kmap_cache {
+	struct kmap_cache_entry	entries[KMAP_CACHE_SIZE];
+	u_int			clock;
+} __aligned(CACHE_LINE_SIZE);
+
+static struct kmap_cache kmap_cache[MAXCPU];
+
+/*
+ * Detach an idle mapping of page with a stale memory attribute, the
+ * caller frees its sf_buf.
+ */
+static struct sf_buf *
+kmap_cache_evict_stale(struct kmap_cache *kc, vm_page_t page,
+    vm_memattr_t attr)
+{
+	struct kmap_cache_entry *e;
+	struct sf_buf *sf;
+	int i;
+
+	for (i = 0; i < KMAP_CACHE_SIZE; i++) {
+		e = &kc->entries[i];
+		if (e->page == page && e->attr != attr && e->refs == 0) {
+			sf = e->sf;
+			e->page = NULL;
+			e->sf = NULL;
+			return (sf);
+		}
+	}
+	return (NULL);
+}
+
+static void *
+kmap_cache_lookup(struct kmap_cache *kc, vm_page_t page, vm_memattr_t attr)
+{
+	struct kmap_cache_entry *e;
+	int i;
+
+	for (i = 0; i < KMAP_CACHE_SIZE; i++) {
+		e = &kc->entries[i];
+		if (e->page == page && e->attr == attr) {
+			e->refs++;
+			e->stamp = ++kc->clock;
+			return ((void *)sf_buf_kva(e->sf));
+		}
+	}
+	return (NULL);
+}
+
+/*
+ * Cache a new mapping in the least recently used idle slot.  Returns
+ * the sf_buf the caller has to free: the evicted one, or sf itself if
+ * every slot is busy and the mapping can't be cached.
+ */
+static struct sf_buf *
+kmap_cache_insert(struct kmap_cache *kc, vm_page_t page, vm_memattr_t attr,
+    struct sf_buf *sf)
+{
+	struct kmap_cache_entry *e, *victim = NULL;
+	struct sf_buf *old;
+	int i;
+
+	for (i = 0; i < KMAP_CACHE_SIZE; i++) {
+		e = &kc->entries[i];
+		if (e->refs != 0)
+			continue;
+		if (e->page == NULL) {
+			victim = e;
+			break;
+		}
+		if (victim == NULL || e->stamp < victim->stamp)
+			victim = e;
+	}
+	if (victim == NULL)
+		return (sf);
+
+	old = victim->sf;
+	victim->page = page;
+	victim->sf = sf;
+	victim->attr = attr;
+	victim->refs = 1;
+	victim->stamp = ++kc->clock;
+	return (old);
+}
+
+/*
+ * Drop a reference on the cached mapping of page or at kva.  Returns
+ * false if the mapping isn't cached.
+ */
+static bool
+kmap_cache_release(struct kmap_cache *kc, vm_page_t page, vm_offset_t kva)
+{
+	struct kmap_cache_entry *e;
+	int i;
+
+	for (i = 0; i < KMAP_CACHE_SIZE; i++) {
+		e = &kc->entries[i];
+		if (e->refs == 0)
+			continue;
+		if ((page != NULL && e->page == page) ||
+		    (page == NULL && sf_buf_kva(e->sf) == kva)) {
+			e->refs--;
+			return (true);
+		}
+	}
+	return (false);
+}
+
+static void
+kunmap_sf_buf(vm_page_t page)
+{
+	struct sf_buf *sf;
+
+	/* lookup SF buffer in list */
+	sf = sf_buf_alloc(page, SFB_NOWAIT | SFB_CPUPRIVATE);
+
+	/* double-free */
+	sf_buf_free(sf);
+	sf_buf_free(sf);
+}
+#endif
+
 void *
 kmap(vm_page_t page)
 {
@@ -76,15 +220,38 @@ kmap(vm_page_t page)
 
 	return ((void *)daddr);
 #else
-	struct sf_buf *sf;
+	struct kmap_cache *kc;
+	struct sf_buf *sf, *old;
+	vm_memattr_t attr;
+	void *kva;
 
 	sched_pin();
+	kc = &kmap_cache[curcpu];
+	attr = pmap_page_get_memattr(page);
+
+	critical_enter();
+	kva = kmap_cache_lookup(kc, page, attr);
+	old = kva == NULL ? kmap_cache_evict_stale(kc, page, attr) : NULL;
+	critical_exit();
+	if (kva != NULL)
+		return (kva);
+	if (old != NULL)
+		sf_buf_free(old);
+
 	sf = sf_buf_alloc(page, SFB_NOWAIT | SFB_CPUPRIVATE);
 	if (sf == NULL) {
 		sched_unpin();
 		return (NULL);
 	}
-	return ((void *)sf_buf_kva(sf));
+	kva = (void *)sf_buf_kva(sf);
+
+	critical_enter();
+	old = kmap_cache_insert(kc, page, attr, sf);
+	critical_exit();
+	/* keep our reference if the mapping didn't make it into the cache */
+	if (old != NULL && old != sf)
+		sf_buf_free(old);
+	return (kva);
 #endif
 }
 
@@ -93,7 +260,9 @@ kmap_atomic_prot(vm_page_t page, pgprot_t prot)
 {
 	vm_memattr_t attr = pgprot2cachemode(prot);
 
-	if (attr != VM_MEMATTR_DEFAULT) {
+	/* changing the attribute means a cache flush and TLB shootdown */
+	if (attr != VM_MEMATTR_DEFAULT &&
+	    pmap_page_get_memattr(page) != attr) {
 		vm_page_lock(page);
 		page->flags |= PG_FICTITIOUS;
 		vm_page_unlock(page);
@@ -114,14 +283,13 @@ kunmap(vm_page_t page)
 #ifdef LINUXKPI_HAVE_DMAP
 	/* NOP */
 #else
-	struct sf_buf *sf;
+	bool cached;
 
-	/* lookup SF buffer in list */
-	sf = sf_buf_alloc(page, SFB_NOWAIT | SFB_CPUPRIVATE);
-
-	/* double-free */
-	sf_buf_free(sf);
-	sf_buf_free(sf);
+	critical_enter();
+	cached = kmap_cache_release(&kmap_cache[curcpu], page, 0);
+	critical_exit();
+	if (!cached)
+		kunmap_sf_buf(page);
 
 	sched_unpin();
 #endif
@@ -133,17 +301,14 @@ kunmap_atomic(void *vaddr)
 #ifdef LINUXKPI_HAVE_DMAP
 	/* NOP */
 #else
-	struct sf_buf *sf;
-	vm_page_t page;
+	bool cached;
 
-	page = virt_to_page(vaddr);
-
-	/* lookup SF buffer in list */
-	sf = sf_buf_alloc(page, SFB_NOWAIT | SFB_CPUPRIVATE);
-
-	/* double-free */
-	sf_buf_free(sf);
-	sf_buf_free(sf);
+	critical_enter();
+	cached = kmap_cache_release(&kmap_cache[curcpu], NULL,
+	    trunc_page((vm_offset_t)vaddr));
+	critical_exit();
+	if (!cached)
+		kunmap_sf_buf(virt_to_page(vaddr));
 
 	sched_unpin();
 #endif
@@ -258,6 +423,42 @@ retry:
 	}
 }
 
+int
+shmem_read_mapping_pages_gfp(vm_object_t obj, vm_pindex_t pindex, int count,
+    gfp_t gfp __unused, struct page **pages)
+{
+	vm_page_t page;
+	int i, rv;
+
+	VM_OBJECT_WLOCK(obj);
+	for (i = 0; i < count; i++) {
+		page = vm_page_grab(obj, pindex + i, VM_ALLOC_NORMAL |
+		    VM_ALLOC_NOBUSY | VM_ALLOC_WIRED);
+		if (page->valid != VM_PAGE_BITS_ALL) {
+			vm_page_xbusy(page);
+			if (vm_pager_has_page(obj, pindex + i, NULL, NULL)) {
+				rv = vm_pager_get_pages(obj, &page, 1, NULL,
+				    NULL);
+				if (rv != VM_PAGER_OK) {
+					vm_page_lock(page);
+					vm_page_unwire(page, PQ_NONE);
+					vm_page_free(page);
+					vm_page_unlock(page);
+					break;
+				}
+			} else {
+				pmap_zero_page(page);
+				page->valid = VM_PAGE_BITS_ALL;
+				page->dirty = 0;
+			}
+			vm_page_xunbusy(page);
+		}
+		pages[i] = page;
+	}
+	VM_OBJECT_WUNLOCK(obj);
+	return (i);
+}
+
 #if defined(__i386__) || defined(__amd64__)
 int
 set_pages_array_wb(struct page **pages, int addrinarray)
@@ -1,19 +1,117 @@
 #include <linux/kernel.h>
 #include <linux/seq_file.h>
+#include <linux/uaccess.h>
+
+/*
+ * Hand out up to size - *copied bytes of the pending record.  The bytes go
+ * to the user buffer if one is given, otherwise they are appended to the
+ * caller's sbuf, and if there is neither they are skipped.
+ */
+static int
+seq_drain(struct seq_file *m, char __user *ubuf, struct sbuf *out,
+    size_t size, size_t *copied)
+{
+	size_t n;
+
+	n = min(m->count - m->from, size - *copied);
+	if (n == 0)
+		return (0);
+	if (ubuf != NULL) {
+		if (copy_to_user(ubuf + *copied, sbuf_data(m->rec) + m->from, n))
+			return (-EFAULT);
+	} else if (out != NULL) {
+		if (sbuf_bcat(out, sbuf_data(m->rec) + m->from, n))
+			return (-ENOMEM);
+	}
+	m->from += n;
+	m->read_pos += n;
+	*copied += n;
+	return (0);
+}
+
+/*
+ * Produce records from the iterator until size bytes have been handed
+ * out.  Only a single record is buffered at a time, so memory use is
+ * bounded by the largest record rather than by the size of the file.
+ */
+static int
+seq_fill(struct seq_file *m, char __user *ubuf, struct sbuf *out,
+    size_t size, size_t *copied)
+{
+	void *p;
+	int rc;
+
+	*copied = 0;
+	rc = seq_drain(m, ubuf, out, size, copied);
+	if (rc || *copied == size)
+		return (rc);
+
+	p = m->op->start(m, &m->index);
+	while (*copied < size) {
+		if (p == NULL || IS_ERR(p)) {
+			rc = IS_ERR(p) ? PTR_ERR(p) : 0;
+			break;
+		}
+		sbuf_clear(m->rec);
+		m->count = m->from = 0;
+		rc = m->op->show(m, p);
+		if (rc < 0)
+			break;
+		if (rc == SEQ_SKIP)
+			sbuf_clear(m->rec);
+		rc = 0;
+		if (sbuf_finish(m->rec)) {
+			rc = -ENOMEM;
+			break;
+		}
+		m->count = sbuf_len(m->rec);
+		p = m->op->next(m, p, &m->index);
+		rc = seq_drain(m, ubuf, out, size, copied);
+		if (rc)
+			break;
+	}
+	m->op->stop(m, p);
+	return (rc);
+}
 
 ssize_t
 linux_seq_read(struct file *f, char __user *ubuf, size_t size, loff_t *ppos)
 {
 	struct seq_file *m = f->private_data;
-	void *p;
+	struct sbuf *out;
+	size_t copied;
 	int rc;
-	loff_t pos = 0;
 
-	p = m->op->start(m, &pos);
-	rc = m->op->show(m, p);		
-	if (rc)
-		return (rc);
-	return (size);
+	/* without a user buffer the output is appended to the caller's sbuf */
+	out = ubuf == NULL ? m->buf : NULL;
+
+	if (m->rec == NULL) {
+		m->rec = sbuf_new(NULL, NULL, PAGE_SIZE, SBUF_AUTOEXTEND);
+		if (m->rec == NULL)
+			return (-ENOMEM);
+	}
+	m->buf = m->rec;
+
+	/* restart the iterator and skip ahead if the caller seeked */
+	if (*ppos != m->read_pos) {
+		m->index = 0;
+		m->count = m->from = 0;
+		m->read_pos = 0;
+		rc = seq_fill(m, NULL, NULL, *ppos, &copied);
+		if (rc == 0 && copied != *ppos)
+			rc = -ESPIPE;
+		if (rc) {
+			m->buf = out;
+			return (rc);
+		}
+	}
+
+	rc = seq_fill(m, ubuf, out, size, &copied);
+	m->buf = out;
+	*ppos += copied;
+	if (copied)
+		return (copied);
+	return (rc);
 }
 
 int
@@ -23,15 +121,23 @@ seq_write(struct seq_file *seq, const void *data, size_t len)
 	return (sbuf_bcpy(seq->buf, data, len));
 }
 
-/*
- * This only needs to be a valid address for lkpi 
- * drivers it should never actually be called
- */
 loff_t
 seq_lseek(struct file *file, loff_t offset, int whence)
 {
-	panic("%s not supported\n", __FUNCTION__);
-	return (0);
+	struct seq_file *m = file->private_data;
+
+	switch (whence) {
+	case SEEK_CUR:
+		offset += m->read_pos;
+		/* FALLTHROUGH */
+	case SEEK_SET:
+		if (offset < 0)
+			return (-EINVAL);
+		/* the next read notices the new position and catches up */
+		return (offset);
+	default:
+		return (-EINVAL);
+	}
 }
 
 static void *
@@ -52,7 +158,7 @@ single_stop(struct seq_file *p, void *v)
 {
 }
 
-static int
+int
 seq_open(struct file *f, const struct seq_operations *op)
 {
 	struct seq_file *p;
@@ -91,12 +197,14 @@ single_open(struct file *f, int (*show)(struct seq_file *, void *), void *d)
 	return (rc);
 }
 
-static int
+int
 seq_release(struct inode *inode, struct file *file)
 {
 	struct seq_file *m;
 
 	m = file->private_data;
+	if (m->rec != NULL)
+		sbuf_delete(m->rec);
 	kfree(m);
 	return (0);
 }
@@ -117,6 +117,8 @@ extern int radeon_auxch;
 extern int radeon_mst;
 extern int radeon_uvd;
 extern int radeon_vce;
+extern int radeon_fence_spin_us;
+extern int radeon_sa_segregated;
 
 /*
  * Copy from radeon_drv.h so we don't have to include both and have conflicting
@@ -366,6 +368,10 @@ struct radeon_fence_driver {
 	atomic64_t			last_seq;
 	bool				initialized, delayed_irq;
 	struct delayed_work		lockup_work;
+	/* adaptive spinning before sleeping, see radeon_fence_wait_seq_timeout() */
+	unsigned			wait_avg_us;
+	atomic64_t			spin_hits;
+	atomic64_t			spin_misses;
 };
 
 struct radeon_fence {
@@ -542,6 +548,11 @@ int radeon_gem_debugfs_init(struct radeon_device *rdev);
  * Assumption is that there won't be hole (all object on same
  * alignment).
  */
+
+/* smallest block and maximum number of block sizes in segregated mode */
+#define RADEON_SA_SEG_MIN_SHIFT		8
+#define RADEON_SA_SEG_MAX_ORDERS	24
+
 struct radeon_sa_manager {
 	wait_queue_head_t	wq;
 	struct radeon_bo	*bo;
@@ -553,6 +564,12 @@ struct radeon_sa_manager {
 	void			*cpu_ptr;
 	uint32_t		domain;
 	uint32_t		align;
+
+	/* segregated mode, free buddy blocks binned by order */
+	bool			segregated;
+	unsigned		seg_orders;
+	unsigned		seg_nbits[RADEON_SA_SEG_MAX_ORDERS];
+	unsigned long		*seg_free[RADEON_SA_SEG_MAX_ORDERS];
 };
 
 struct radeon_sa_bo;
@@ -203,6 +203,8 @@ int radeon_auxch = -1;
 int radeon_mst = 0;
 int radeon_uvd = 1;
 int radeon_vce = 1;
+int radeon_fence_spin_us = 10;
+int radeon_sa_segregated = 0;
 
 MODULE_PARM_DESC(no_wb, "Disable AGP writeback for scratch registers");
 module_param_named(no_wb, radeon_no_wb, int, 0444);
@@ -300,6 +302,12 @@ module_param_named(uvd, radeon_uvd, int, 0444);
 MODULE_PARM_DESC(vce, "vce enable/disable vce support (1 = enable, 0 = disable)");
 module_param_named(vce, radeon_vce, int, 0444);
 
+MODULE_PARM_DESC(fence_spin_us, "Maximum time to busy-wait on a fence before sleeping, in microseconds (0 = disabled, default 10)");
+module_param_named(fence_spin_us, radeon_fence_spin_us, int, 0644);
+
+MODULE_PARM_DESC(sa_segregated, "Segregated-fit IB pool suballocation (1 = enable, 0 = ring allocator (default))");
+module_param_named(sa_segregated, radeon_sa_segregated, int, 0444);
+
 static struct pci_device_id pciidlist[] = {
 	radeon_PCI_IDS
 };
@@ -466,6 +466,99 @@ static bool radeon_fence_any_seq_signaled(struct radeon_device *rdev, u64 *seq)
 	return false;
 }
 
+/* longest wait accounted in the running average */
+#define RADEON_FENCE_WAIT_AVG_MAX_US	10000
+
+/**
+ * radeon_fence_spin_budget - how long to busy-wait before sleeping
+ *
+ * @rdev: radeon device pointer
+ * @seq: sequence numbers
+ *
+ * Spin for about twice the recent average wait of the rings waited on,
+ * capped by the fence_spin_us module parameter. When recent waits were
+ * longer than the cap only spin for a fraction of it, to notice when
+ * the rings get back to short jobs.
+ */
+static unsigned radeon_fence_spin_budget(struct radeon_device *rdev, u64 *seq)
+{
+	unsigned hi = radeon_fence_spin_us;
+	unsigned lo = hi / 8 ? hi / 8 : 1;
+	unsigned budget = 0;
+	unsigned i;
+
+	if (radeon_fence_spin_us <= 0)
+		return 0;
+
+	for (i = 0; i < RADEON_NUM_RINGS; ++i) {
+		unsigned avg = ACCESS_ONCE(rdev->fence_drv[i].wait_avg_us);
+
+		if (!seq[i])
+			continue;
+
+		if (avg > hi)
+			budget = max(budget, lo);
+		else
+			budget = max(budget, clamp(2 * avg, lo, hi));
+	}
+	return budget;
+}
+
+/**
+ * radeon_fence_wait_account - update the running average wait times
+ *
+ * @rdev: radeon device pointer
+ * @seq: sequence numbers
+ * @start: when the wait started
+ */
+static void radeon_fence_wait_account(struct radeon_device *rdev, u64 *seq,
+				      ktime_t start)
+{
+	s64 us = ktime_to_us(ktime_sub(ktime_get(), start));
+	unsigned i;
+
+	us = min_t(s64, us, RADEON_FENCE_WAIT_AVG_MAX_US);
+	for (i = 0; i < RADEON_NUM_RINGS; ++i) {
+		unsigned avg = ACCESS_ONCE(rdev->fence_drv[i].wait_avg_us);
+
+		if (seq[i])
+			ACCESS_ONCE(rdev->fence_drv[i].wait_avg_us) =
+				(avg * 7 + (unsigned)us) / 8;
+	}
+}
+
+/**
+ * radeon_fence_spin - busy-wait for specific sequence numbers
+ *
+ * @rdev: radeon device pointer
+ * @seq: sequence numbers
+ * @intr: stop on pending signals
+ * @start: when the wait started
+ * @budget_us: how long to spin
+ *
+ * Poll the fence values for a short while, so that short jobs don't
+ * pay for the interrupt and wake-up latency.
+ * Returns true if any sequence number signaled while spinning.
+ */
+static bool radeon_fence_spin(struct radeon_device *rdev, u64 *seq,
+			      bool intr, ktime_t start, unsigned budget_us)
+{
+	do {
+		if (radeon_fence_any_seq_signaled(rdev, seq))
+			return true;
+
+		if (rdev->needs_reset || (intr && signal_pending(current)))
+			break;
+
+		if (ktime_to_us(ktime_sub(ktime_get(), start)) >= budget_us)
+			break;
+
+		cpu_relax();
+	} while (!need_resched());
+
+	return false;
+}
+
 /**
  * radeon_fence_wait_seq_timeout - wait for a specific sequence numbers
  *
@@ -487,12 +580,37 @@ static long radeon_fence_wait_seq_timeout(struct radeon_device *rdev,
 					  u64 *target_seq, bool intr,
 					  long timeout)
 {
+	unsigned budget;
+	ktime_t start;
 	long r;
 	int i;
 
 	if (radeon_fence_any_seq_signaled(rdev, target_seq))
 		return timeout;
 
+	/* spin for a little while before sleeping on the IRQ */
+	start = ktime_get();
+	budget = timeout ? radeon_fence_spin_budget(rdev, target_seq) : 0;
+	if (budget) {
+		bool signaled;
+
+		signaled = radeon_fence_spin(rdev, target_seq, intr, start,
+					     budget);
+		for (i = 0; i < RADEON_NUM_RINGS; ++i) {
+			if (!target_seq[i])
+				continue;
+
+			if (signaled)
+				atomic64_inc(&rdev->fence_drv[i].spin_hits);
+			else
+				atomic64_inc(&rdev->fence_drv[i].spin_misses);
+		}
+		if (signaled) {
+			radeon_fence_wait_account(rdev, target_seq, start);
+			return timeout;
+		}
+	}
+
 	/* enable IRQs and tracing */
 	for (i = 0; i < RADEON_NUM_RINGS; ++i) {
 		if (!target_seq[i])
@@ -514,6 +632,8 @@ static long radeon_fence_wait_seq_timeout(struct radeon_device *rdev,
 
 	if (rdev->needs_reset)
 		r = -EDEADLK;
+	else if (r > 0)
+		radeon_fence_wait_account(rdev, target_seq, start);
 
 	for (i = 0; i < RADEON_NUM_RINGS; ++i) {
 		if (!target_seq[i])
@@ -883,6 +1003,9 @@ static void radeon_fence_driver_init_ring(struct radeon_device *rdev, int ring)
 		rdev->fence_drv[ring].sync_seq[i] = 0;
 	atomic64_set(&rdev->fence_drv[ring].last_seq, 0);
 	rdev->fence_drv[ring].initialized = false;
+	rdev->fence_drv[ring].wait_avg_us = 0;
+	atomic64_set(&rdev->fence_drv[ring].spin_hits, 0);
+	atomic64_set(&rdev->fence_drv[ring].spin_misses, 0);
 	INIT_DELAYED_WORK(&rdev->fence_drv[ring].lockup_work,
 			  radeon_fence_check_lockup);
 	rdev->fence_drv[ring].rdev = rdev;
@@ -983,6 +1106,12 @@ static int radeon_debugfs_fence_info(struct seq_file *m, void *data)
 			   (unsigned long long)atomic64_read(&rdev->fence_drv[i].last_seq));
 		seq_printf(m, "Last emitted        0x%016llx\n",
 			   rdev->fence_drv[i].sync_seq[i]);
+		seq_printf(m, "Average wait        %u us\n",
+			   ACCESS_ONCE(rdev->fence_drv[i].wait_avg_us));
+		seq_printf(m, "Spin hits           %llu\n",
+			   (unsigned long long)atomic64_read(&rdev->fence_drv[i].spin_hits));
+		seq_printf(m, "Spin misses         %llu\n",
+			   (unsigned long long)atomic64_read(&rdev->fence_drv[i].spin_misses));
 
 		for (j = 0; j < RADEON_NUM_RINGS; ++j) {
 			if (i != j && rdev->fence_drv[j].initialized)
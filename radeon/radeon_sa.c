@@ -40,6 +40,12 @@
  *
  * If we are asked to block we wait on all the oldest fence of all
  * rings. We just wait for any of those fence to complete.
+ *
+ * With the sa_segregated module parameter the manager instead splits the
+ * buffer into power of two buddy blocks binned by size.  Freed bos still
+ * go to the per ring fence lists, but every ring returns its retired
+ * blocks on its own, so a slow ring no longer holds a single hole back
+ * for all the others.  Free buddies are merged again on release.
  */
 #include <drm/drmP.h>
 #include "radeon.h"
@@ -47,6 +53,210 @@
 static void radeon_sa_bo_remove_locked(struct radeon_sa_bo *sa_bo);
 static void radeon_sa_bo_try_free(struct radeon_sa_manager *sa_manager);
 
+static unsigned radeon_sa_seg_order(unsigned size, unsigned align)
+{
+	unsigned bytes = max(size, align);
+	unsigned order = 0;
+
+	while ((1u << (RADEON_SA_SEG_MIN_SHIFT + order)) < bytes)
+		++order;
+	return order;
+}
+
+static void radeon_sa_seg_put_block(struct radeon_sa_manager *sa_manager,
+				    unsigned soffset, unsigned order)
+{
+	unsigned idx = soffset >> (RADEON_SA_SEG_MIN_SHIFT + order);
+	unsigned buddy;
+
+	/* merge with the buddy for as long as it is free as well */
+	while (order + 1 < sa_manager->seg_orders) {
+		buddy = idx ^ 1;
+		if (buddy >= sa_manager->seg_nbits[order] ||
+		    !test_bit(buddy, sa_manager->seg_free[order]))
+			break;
+		__clear_bit(buddy, sa_manager->seg_free[order]);
+		idx >>= 1;
+		++order;
+	}
+	__set_bit(idx, sa_manager->seg_free[order]);
+}
+
+static bool radeon_sa_seg_get_block(struct radeon_sa_manager *sa_manager,
+				    unsigned order, unsigned *soffset)
+{
+	unsigned k, idx;
+
+	for (k = order; k < sa_manager->seg_orders; ++k) {
+		idx = find_first_bit(sa_manager->seg_free[k],
+				     sa_manager->seg_nbits[k]);
+		if (idx >= sa_manager->seg_nbits[k])
+			continue;
+
+		__clear_bit(idx, sa_manager->seg_free[k]);
+		/* split, keeping the lower half and freeing the upper one */
+		while (k > order) {
+			--k;
+			idx <<= 1;
+			__set_bit(idx + 1, sa_manager->seg_free[k]);
+		}
+		*soffset = idx << (RADEON_SA_SEG_MIN_SHIFT + order);
+		return true;
+	}
+	return false;
+}
+
+static bool radeon_sa_seg_has_block(struct radeon_sa_manager *sa_manager,
+				    unsigned order)
+{
+	unsigned k;
+
+	for (k = order; k < sa_manager->seg_orders; ++k)
+		if (find_first_bit(sa_manager->seg_free[k],
+				   sa_manager->seg_nbits[k]) <
+		    sa_manager->seg_nbits[k])
+			return true;
+	return false;
+}
+
+static int radeon_sa_seg_init(struct radeon_sa_manager *sa_manager)
+{
+	unsigned blocks = sa_manager->size >> RADEON_SA_SEG_MIN_SHIFT;
+	unsigned i, longs, soffset, order, block;
+	unsigned long *bits;
+
+	sa_manager->seg_orders = 0;
+	while (sa_manager->seg_orders < RADEON_SA_SEG_MAX_ORDERS &&
+	       (1u << sa_manager->seg_orders) <= blocks)
+		++sa_manager->seg_orders;
+	if (!sa_manager->seg_orders)
+		return -EINVAL;
+
+	for (i = 0, longs = 0; i < sa_manager->seg_orders; ++i) {
+		sa_manager->seg_nbits[i] = blocks >> i;
+		longs += BITS_TO_LONGS(sa_manager->seg_nbits[i]);
+	}
+
+	bits = kcalloc(longs, sizeof(unsigned long), GFP_KERNEL);
+	if (!bits)
+		return -ENOMEM;
+
+	for (i = 0; i < sa_manager->seg_orders; ++i) {
+		sa_manager->seg_free[i] = bits;
+		bits += BITS_TO_LONGS(sa_manager->seg_nbits[i]);
+	}
+
+	/* seed the free lists with the largest aligned blocks that fit */
+	for (soffset = 0; soffset < (blocks << RADEON_SA_SEG_MIN_SHIFT);
+	     soffset += block) {
+		order = sa_manager->seg_orders - 1;
+		block = 1u << (RADEON_SA_SEG_MIN_SHIFT + order);
+		while ((soffset & (block - 1)) ||
+		       soffset + block > sa_manager->size) {
+			--order;
+			block >>= 1;
+		}
+		radeon_sa_seg_put_block(sa_manager, soffset, order);
+	}
+	return 0;
+}
+
+/* hand back what any ring has retired, without waiting on the others */
+static void radeon_sa_seg_try_free(struct radeon_sa_manager *sa_manager)
+{
+	struct radeon_sa_bo *sa_bo, *tmp;
+	int i;
+
+	for (i = 0; i < RADEON_NUM_RINGS; ++i) {
+		list_for_each_entry_safe(sa_bo, tmp, &sa_manager->flist[i],
+					 flist) {
+			if (!radeon_fence_signaled(sa_bo->fence))
+				break;
+			radeon_sa_bo_remove_locked(sa_bo);
+		}
+	}
+}
+
+static bool radeon_sa_seg_try_alloc(struct radeon_sa_manager *sa_manager,
+				    struct radeon_sa_bo *sa_bo,
+				    unsigned size, unsigned align)
+{
+	unsigned order = radeon_sa_seg_order(size, align);
+	unsigned soffset;
+
+	if (!radeon_sa_seg_get_block(sa_manager, order, &soffset))
+		return false;
+
+	sa_bo->manager = sa_manager;
+	sa_bo->soffset = soffset;
+	sa_bo->eoffset = soffset + (1u << (RADEON_SA_SEG_MIN_SHIFT + order));
+	list_add_tail(&sa_bo->olist, &sa_manager->olist);
+	INIT_LIST_HEAD(&sa_bo->flist);
+	return true;
+}
+
+static bool radeon_sa_seg_event(struct radeon_sa_manager *sa_manager,
+				unsigned size, unsigned align)
+{
+	int i;
+
+	for (i = 0; i < RADEON_NUM_RINGS; ++i)
+		if (!list_empty(&sa_manager->flist[i]))
+			return true;
+
+	return radeon_sa_seg_has_block(sa_manager,
+				       radeon_sa_seg_order(size, align));
+}
+
+static int radeon_sa_seg_bo_new(struct radeon_device *rdev,
+				struct radeon_sa_manager *sa_manager,
+				struct radeon_sa_bo *sa_bo,
+				unsigned size, unsigned align)
+{
+	struct radeon_fence *fences[RADEON_NUM_RINGS];
+	struct radeon_sa_bo *oldest;
+	int i, r;
+
+	if (radeon_sa_seg_order(size, align) >= sa_manager->seg_orders)
+		return -EINVAL;
+
+	spin_lock(&sa_manager->wq.lock);
+	do {
+		radeon_sa_seg_try_free(sa_manager);
+
+		if (radeon_sa_seg_try_alloc(sa_manager, sa_bo, size, align)) {
+			spin_unlock(&sa_manager->wq.lock);
+			return 0;
+		}
+
+		/* wait for whichever ring retires its oldest bo first */
+		for (i = 0; i < RADEON_NUM_RINGS; ++i) {
+			fences[i] = NULL;
+			if (list_empty(&sa_manager->flist[i]))
+				continue;
+			oldest = list_first_entry(&sa_manager->flist[i],
+						  struct radeon_sa_bo, flist);
+			fences[i] = radeon_fence_ref(oldest->fence);
+		}
+
+		spin_unlock(&sa_manager->wq.lock);
+		r = radeon_fence_wait_any(rdev, fences, false);
+		for (i = 0; i < RADEON_NUM_RINGS; ++i)
+			radeon_fence_unref(&fences[i]);
+		spin_lock(&sa_manager->wq.lock);
+		/* if we have nothing to wait for block */
+		if (r == -ENOENT) {
+			r = wait_event_interruptible_locked(
+				sa_manager->wq,
+				radeon_sa_seg_event(sa_manager, size, align)
+			);
+		}
+	} while (!r);
+
+	spin_unlock(&sa_manager->wq.lock);
+	return r;
+}
+
 int radeon_sa_bo_manager_init(struct radeon_device *rdev,
 			      struct radeon_sa_manager *sa_manager,
 			      unsigned size, u32 align, u32 domain, u32 flags)
@@ -64,10 +274,21 @@ int radeon_sa_bo_manager_init(struct radeon_device *rdev,
 		INIT_LIST_HEAD(&sa_manager->flist[i]);
 	}
 
+	sa_manager->segregated = radeon_sa_segregated != 0;
+	if (sa_manager->segregated) {
+		r = radeon_sa_seg_init(sa_manager);
+		if (r) {
+			dev_err(rdev->dev, "(%d) failed to init segregated sa manager\n", r);
+			return r;
+		}
+	}
+
 	r = radeon_bo_create(rdev, size, align, true,
 			     domain, flags, NULL, NULL, &sa_manager->bo);
 	if (r) {
 		dev_err(rdev->dev, "(%d) failed to allocate bo for manager\n", r);
+		if (sa_manager->segregated)
+			kfree(sa_manager->seg_free[0]);
 		return r;
 	}
 
@@ -80,8 +301,11 @@ void radeon_sa_bo_manager_fini(struct radeon_device *rdev,
 	struct radeon_sa_bo *sa_bo, *tmp;
 
 	if (!list_empty(&sa_manager->olist)) {
-		sa_manager->hole = &sa_manager->olist,
-		radeon_sa_bo_try_free(sa_manager);
+		sa_manager->hole = &sa_manager->olist;
+		if (sa_manager->segregated)
+			radeon_sa_seg_try_free(sa_manager);
+		else
+			radeon_sa_bo_try_free(sa_manager);
 		if (!list_empty(&sa_manager->olist)) {
 			dev_err(rdev->dev, "sa_manager is not empty, clearing anyway\n");
 		}
@@ -89,6 +313,10 @@ void radeon_sa_bo_manager_fini(struct radeon_device *rdev,
 	list_for_each_entry_safe(sa_bo, tmp, &sa_manager->olist, olist) {
 		radeon_sa_bo_remove_locked(sa_bo);
 	}
+	if (sa_manager->segregated) {
+		kfree(sa_manager->seg_free[0]);
+		sa_manager->segregated = false;
+	}
 	radeon_bo_unref(&sa_manager->bo);
 	sa_manager->size = 0;
 }
@@ -142,7 +370,11 @@ int radeon_sa_bo_manager_suspend(struct radeon_device *rdev,
 static void radeon_sa_bo_remove_locked(struct radeon_sa_bo *sa_bo)
 {
 	struct radeon_sa_manager *sa_manager = sa_bo->manager;
-	if (sa_manager->hole == &sa_bo->olist) {
+	if (sa_manager->segregated) {
+		radeon_sa_seg_put_block(sa_manager, sa_bo->soffset,
+			ilog2((sa_bo->eoffset - sa_bo->soffset) >>
+			      RADEON_SA_SEG_MIN_SHIFT));
+	} else if (sa_manager->hole == &sa_bo->olist) {
 		sa_manager->hole = sa_bo->olist.prev;
 	}
 	list_del_init(&sa_bo->olist);
@@ -330,6 +562,15 @@ int radeon_sa_bo_new(struct radeon_device *rdev,
 	INIT_LIST_HEAD(&(*sa_bo)->olist);
 	INIT_LIST_HEAD(&(*sa_bo)->flist);
 
+	if (sa_manager->segregated) {
+		r = radeon_sa_seg_bo_new(rdev, sa_manager, *sa_bo, size, align);
+		if (r) {
+			kfree(*sa_bo);
+			*sa_bo = NULL;
+		}
+		return r;
+	}
+
 	spin_lock(&sa_manager->wq.lock);
 	do {
 		for (i = 0; i < RADEON_NUM_RINGS; ++i) {
@@ -401,6 +642,7 @@ void radeon_sa_bo_dump_debug_info(struct radeon_sa_manager *sa_manager,
 				  struct seq_file *m)
 {
 	struct radeon_sa_bo *i;
+	unsigned j;
 
 	spin_lock(&sa_manager->wq.lock);
 	list_for_each_entry(i, &sa_manager->olist, olist) {
@@ -419,6 +661,11 @@ void radeon_sa_bo_dump_debug_info(struct radeon_sa_manager *sa_manager,
 		}
 		seq_printf(m, "\n");
 	}
+	for (j = 0; sa_manager->segregated && j < sa_manager->seg_orders; ++j)
+		seq_printf(m, "free blocks of %8u bytes: %u\n",
+			   1u << (RADEON_SA_SEG_MIN_SHIFT + j),
+			   bitmap_weight(sa_manager->seg_free[j],
+					 sa_manager->seg_nbits[j]));
 	spin_unlock(&sa_manager->wq.lock);
 }
 #endif